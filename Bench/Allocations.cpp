@@ -0,0 +1,108 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "Allocations.h"
+#include <cstdlib>
+#include <cstddef>
+#include <cerrno>
+#if defined(BENCH_ALLOC_HOOKS) && defined(__GLIBC__)
+#include <malloc.h>
+#define BENCH_ALLOC_TRACKING 1
+#endif
+
+// counters of the thread, zero-initialized static TLS doesn't allocate
+static thread_local bool          t_enabled  = false;
+static thread_local AllocCounters t_counters = {};
+//+------------------------------------------------------------------+
+//| Tracking is compiled in                                          |
+//+------------------------------------------------------------------+
+bool AllocTracker::Available() {
+#ifdef BENCH_ALLOC_TRACKING
+   return true;
+#else
+   return false;
+#endif
+}
+//+------------------------------------------------------------------+
+//|                                                                  |
+//+------------------------------------------------------------------+
+void AllocTracker::Enable()  { t_enabled = true;  }
+void AllocTracker::Disable() { t_enabled = false; }
+void AllocTracker::Reset()   { t_counters = {};   }
+AllocCounters AllocTracker::Counters() { return t_counters; }
+
+#ifdef BENCH_ALLOC_TRACKING
+//+------------------------------------------------------------------+
+//| Account allocated and freed blocks by their usable size          |
+//+------------------------------------------------------------------+
+static inline void Allocated(void* ptr, size_t size) {
+   if (!t_enabled || !ptr) return;
+   t_counters.allocations++;
+   t_counters.bytes += size;
+   t_counters.live  += int64_t(malloc_usable_size(ptr));
+   if (t_counters.live > t_counters.peak) t_counters.peak = t_counters.live;
+}
+static inline void Freed(void* ptr) {
+   if (!t_enabled || !ptr) return;
+   t_counters.frees++;
+   t_counters.live -= int64_t(malloc_usable_size(ptr));
+}
+//+------------------------------------------------------------------+
+//| glibc allocator entry points                                     |
+//+------------------------------------------------------------------+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void  __libc_free(void* ptr);
+}
+//+------------------------------------------------------------------+
+//| Interposed malloc family, operator new of libstdc++ calls malloc |
+//+------------------------------------------------------------------+
+extern "C" {
+void* malloc(size_t size) {
+   void* ptr = __libc_malloc(size);
+   Allocated(ptr, size);
+   return ptr;
+}
+void* calloc(size_t count, size_t size) {
+   void* ptr = __libc_calloc(count, size);
+   Allocated(ptr, count * size);
+   return ptr;
+}
+void* realloc(void* ptr, size_t size) {
+   int64_t old = (t_enabled && ptr) ? int64_t(malloc_usable_size(ptr)) : 0;
+   void*   res = __libc_realloc(ptr, size);
+   // resized block is a free and a new allocation, failed realloc keeps the old block
+   if (t_enabled && ptr && (res || size == 0)) {
+      t_counters.frees++;
+      t_counters.live -= old;
+   }
+   Allocated(res, size);
+   return res;
+}
+void* memalign(size_t alignment, size_t size) {
+   void* ptr = __libc_memalign(alignment, size);
+   Allocated(ptr, size);
+   return ptr;
+}
+void* aligned_alloc(size_t alignment, size_t size) {
+   return memalign(alignment, size);
+}
+int posix_memalign(void** res, size_t alignment, size_t size) {
+   if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) return EINVAL;
+   void* ptr = memalign(alignment, size);
+   if (!ptr) return ENOMEM;
+   *res = ptr;
+   return 0;
+}
+void free(void* ptr) {
+   Freed(ptr);
+   __libc_free(ptr);
+}
+}
+#endif
+//+------------------------------------------------------------------+
@@ -0,0 +1,34 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include <cstdint>
+
+//+------------------------------------------------------------------+
+//| Heap activity of a thread while tracking is enabled              |
+//+------------------------------------------------------------------+
+struct AllocCounters {
+   uint64_t       allocations;               // malloc, calloc, realloc, aligned and operator new calls
+   uint64_t       frees;                     // free and operator delete calls of non-null pointers
+   uint64_t       bytes;                     // requested bytes
+   int64_t        live;                      // usable bytes allocated minus freed
+   int64_t        peak;                      // peak of live bytes
+};
+//+------------------------------------------------------------------+
+//| Allocations of the calling thread. The host interposes malloc    |
+//| family of glibc (BENCH_ALLOC_HOOKS build), so allocations of     |
+//| plugins and of the C++ runtime are counted too, other platforms  |
+//| have no tracking.                                                |
+//+------------------------------------------------------------------+
+class AllocTracker {
+public:
+   static bool       Available();
+   // counting switch of the calling thread
+   static void       Enable();
+   static void       Disable();
+   static void       Reset();
+   static AllocCounters Counters();
+};
+//+------------------------------------------------------------------+
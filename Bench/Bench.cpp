@@ -4,34 +4,91 @@
 //|                                    https://github.com/arthur-cpp |
 //+------------------------------------------------------------------+
 #include "Benchmark.h"
-#if _DEBUG
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#if defined(_WIN32) && defined(_DEBUG)
 #define _CRTDBG_MAP_ALLOC
 #include <cstdlib>
 #include <crtdbg.h>
 #endif
 
+//+------------------------------------------------------------------+
+//| Ctrl+C stops tests at the next sample, the second one terminates |
+//+------------------------------------------------------------------+
+static void OnInterrupt(int) {
+   ExtStop = true;
+   signal(SIGINT, SIG_DFL);
+}
+//+------------------------------------------------------------------+
+//| Command line usage                                               |
+//+------------------------------------------------------------------+
+static int Usage() {
+   std::cerr << "Usage: bench [--compare baseline.json] [--threshold 0.05]" << std::endl;
+   std::cerr << "       bench --worker host:port --test name --process index" << std::endl;
+   return 2;
+}
 //+------------------------------------------------------------------+
 //| Main entry point                                                 |
 //+------------------------------------------------------------------+
-int main() {
+int main(int argc, char* argv[]) {
    Benchmark bench;
+   int       res = 0;
+   std::string baseline;
+   double    threshold = Results::THRESHOLD_DEFAULT;
+   std::string worker, worker_test;
+   size_t    worker_index = 0;
 
    // check for leaks in debug mode
-#if _DEBUG
+#if defined(_WIN32) && defined(_DEBUG)
    _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 #endif
 
    // prepare program path
    char* cp;
-   GetModuleFileName(NULL, ExtProgramPath, _countof(ExtProgramPath));
-   if ((cp = strrchr(ExtProgramPath, '\\')) != NULL) *cp = 0;
+#ifdef _WIN32
+   GetModuleFileName(NULL, ExtProgramPath, sizeof(ExtProgramPath));
+#else
+   ssize_t len = readlink("/proc/self/exe", ExtProgramPath, sizeof(ExtProgramPath) - 1);
+   ExtProgramPath[len > 0 ? len : 0] = 0;
+#endif
+   if ((cp = strrchr(ExtProgramPath, BENCH_PATH_SEP[0])) != NULL) *cp = 0;
+
+   // command line
+   for (int i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc)
+         baseline = argv[++i];
+      else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+         threshold = atof(argv[++i]);
+      // worker process of a multi-process test
+      else if (strcmp(argv[i], "--worker") == 0 && i + 1 < argc)
+         worker = argv[++i];
+      else if (strcmp(argv[i], "--test") == 0 && i + 1 < argc)
+         worker_test = Coordinator::DecodeName(argv[++i]);
+      else if (strcmp(argv[i], "--process") == 0 && i + 1 < argc)
+         worker_index = size_t(strtoull(argv[++i], NULL, 10));
+      else
+         return Usage();
+   }
+   if (!baseline.empty()) bench.SetBaseline(baseline, threshold);
+   if (!worker.empty()) {
+      if (worker_test.empty()) return Usage();
+      bench.SetWorker(worker, worker_test, worker_index);
+   }
    
+   // stop gracefully with partial results
+   signal(SIGINT, OnInterrupt);
+
    // load config
    if (bench.LoadConfig()) {
-      bench.Run();
+      res = bench.Run();
    }
 
    // finish
-   return 0;
+   return res;
 }
 //+------------------------------------------------------------------+
@@ -4,6 +4,14 @@
 //|                                    https://github.com/arthur-cpp |
 //+------------------------------------------------------------------+
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+#include <map>
 // yaml-cpp
 #define YAML_CPP_STATIC_DEFINE
 #include <yaml-cpp/yaml.h>
@@ -13,7 +21,7 @@
 //+------------------------------------------------------------------+
 //|                                                                  |
 //+------------------------------------------------------------------+
-Benchmark::Benchmark()  {}
+Benchmark::Benchmark() : m_clock(Clock::Default()), m_clock_subtract(false), m_results("results.json"), m_threshold(Results::THRESHOLD_DEFAULT), m_worker_index(0) {}
 Benchmark::~Benchmark() {}
 //+------------------------------------------------------------------+
 //|                                                                  |
@@ -21,21 +29,107 @@ Benchmark::~Benchmark() {}
 bool Benchmark::LoadConfig() {
    char filename[MAX_PATH];
    try {
-      _snprintf_s(filename, _countof(filename), _TRUNCATE, "%s\\config.yaml", ExtProgramPath);
+      int len = snprintf(filename, sizeof(filename), "%s" BENCH_PATH_SEP "config.yaml", ExtProgramPath);
+      if (len < 0 || size_t(len) >= sizeof(filename)) {
+         std::cerr << "Config: program path is too long" << std::endl;
+         return false;
+      }
       YAML::Node config = YAML::LoadFile(filename);
 
       // global settings
-      int concurrency, samples;
+      size_t batch;
+      int    precision;
+      std::vector<size_t> concurrency;
+      size_t samples = 1'000'000, warmup_samples = 0;
+      bool   samples_auto = false;
+      double ci_width = CI_WIDTH_DEFAULT;
+      uint64_t duration = 0, warmup = 0;
+      std::string trace;
+      EnRecording recording = RECORDING_SAMPLES;
+      uint32_t    counters  = 0;
+      EnCounterScope counters_scope = COUNTERS_SCOPE_LOOP;
+      double      rate      = 0;
+      double      items     = 0, bytes = 0;
+      bool        allocations = false;
+      EnIsolation isolation = ISOLATION_NONE;
+      size_t      processes = 1;
+      std::string launch, coordinator;
+      EnArrival   arrival   = ARRIVAL_CONSTANT;
+      EnStart     start     = START_BARRIER;
+      uint64_t    start_spin = START_SPIN_DEFAULT;
+      EnAffinity  affinity  = AFFINITY_NONE;
+      size_t      ring      = 0;
+      uint64_t    window    = 0;
+      bool        progress  = false;
+      bool        window_threads = true;
+      unsigned    pages     = 0;
+      std::vector<int> affinity_cpus;
 
       // number of concurrent threads
-      if (config["concurrency"]) concurrency = config["concurrency"].as<int>();
-      else                       concurrency = std::thread::hardware_concurrency();
+      if (config["concurrency"]) concurrency = ParseConcurrency(config["concurrency"]);
+      if (concurrency.empty())   concurrency.push_back(std::thread::hardware_concurrency());
       // number of test iterations per thread
-      if (config["samples"])     samples = config["samples"].as<int>();
-      else                       samples = 1'000'000;
+      if (config["samples"])     ParseSamples(config["samples"], samples, samples_auto);
+      // time limit, or time cap of samples: auto
+      if (config["duration"])    duration = ParseDuration(config["duration"].as<std::string>());
+      if (config["ci_width"])    ci_width = config["ci_width"].as<double>();
+      // discarded warmup
+      if (config["warmup"])      warmup = ParseDuration(config["warmup"].as<std::string>());
+      if (config["warmup_samples"]) warmup_samples = config["warmup_samples"].as<size_t>();
+      // number of test function calls per sample
+      if (config["batch"])       batch = ParseBatch(config["batch"]);
+      else                       batch = 1;
+      // samples recording mode and histogram precision
+      if (config["recording"])   recording = ParseRecording(config["recording"].as<std::string>(), recording);
+      if (config["precision"])   precision = config["precision"].as<int>();
+      else                       precision = Histogram::DIGITS_DEFAULT;
+      // binary trace of all samples
+      if (config["trace"])       trace = config["trace"].as<std::string>();
+      // machine-readable results of all tests
+      if (config["results"])     m_results = config["results"].as<std::string>();
+      // status every second
+      if (config["progress"])    progress = config["progress"].as<bool>();
+      // time series of throughput and latency
+      if (config["window"])      window = ParseDuration(config["window"].as<std::string>());
+      if (config["window_threads"]) window_threads = config["window_threads"].as<bool>();
+      // samples buffer
+      if (config["ring"])        ring = config["ring"].as<size_t>();
+      if (config["huge_pages"] && config["huge_pages"].as<bool>()) pages |= PAGES_HUGE;
+      if (config["lock_pages"] && config["lock_pages"].as<bool>()) pages |= PAGES_LOCKED;
+      // performance counters and counted region
+      if (config["counters"])    counters = ParseCounters(config["counters"]);
+      if (config["counters_scope"]) counters_scope = ParseCountersScope(config["counters_scope"].as<std::string>(), counters_scope);
+      // open-loop fixed rate of all threads
+      if (config["rate"])        rate = config["rate"].as<double>();
+      if (config["arrival"])     arrival = ParseArrival(config["arrival"].as<std::string>(), arrival);
+      // start of the measured part
+      if (config["start"])       start = ParseStart(config["start"].as<std::string>(), start);
+      if (config["start_spin"])  start_spin = ParseDuration(config["start_spin"].as<std::string>());
+      // work done by every call
+      if (config["items"])       items = config["items"].as<double>();
+      if (config["bytes"])       bytes = config["bytes"].as<double>();
+      // heap allocations of the measured calls
+      if (config["allocations"]) allocations = config["allocations"].as<bool>();
+      // every test in its own process
+      if (config["isolation"])   isolation = ParseIsolation(config["isolation"].as<std::string>(), isolation);
+      // worker processes of every test
+      if (config["processes"])   processes = config["processes"].as<size_t>();
+      if (config["launch"])      launch = config["launch"].as<std::string>();
+      if (config["coordinator"]) coordinator = config["coordinator"].as<std::string>();
+      // threads placement
+      if (config["affinity"])    ParseAffinity(config["affinity"], affinity, affinity_cpus);
 
-      // read tests configurations
-      for (const auto& test : config["tests"]) {
+      // timer backend and its probe overhead handling
+      if (config["clock"]) {
+         std::string clock = config["clock"].as<std::string>();
+         if (!Clock::Parse(clock, m_clock))
+            std::cerr << "Config: unknown clock \"" << clock << "\", \"" << Clock::Name(m_clock) << "\" is used" << std::endl;
+      }
+      if (config["clock_overhead"])
+         m_clock_subtract = config["clock_overhead"].as<std::string>() == "subtract";
+
+      // test configuration, missing parameters are taken from the global settings
+      auto parse_test = [&](const YAML::Node& test) {
          TestCfg cfg;
          // test name and name of the DLL
          cfg.name   = test["name"].as<std::string>();
@@ -49,14 +143,95 @@ bool Benchmark::LoadConfig() {
             cfg.thread_default.context = test["context_init"].as<std::string>();
          
          // number of concurrent threads
-         if (test["concurrency"]) cfg.concurrency = test["concurrency"].as<int>();
-         else                     cfg.concurrency = concurrency;
+         if (test["concurrency"]) cfg.sweep = ParseConcurrency(test["concurrency"]);
+         if (cfg.sweep.empty())   cfg.sweep = concurrency;
+         // single level is not a sweep
+         cfg.concurrency = cfg.sweep[0];
+         if (cfg.sweep.size() < 2) cfg.sweep.clear();
          // number of test iterations per thread
-         if (test["samples"])     cfg.samples = test["samples"].as<int>();
-         else                     cfg.samples = samples;
+         cfg.samples      = samples;
+         cfg.samples_auto = samples_auto;
+         if (test["samples"])     ParseSamples(test["samples"], cfg.samples, cfg.samples_auto);
+         // time limit, or time cap of samples: auto
+         if (test["duration"])    cfg.duration = ParseDuration(test["duration"].as<std::string>());
+         else                     cfg.duration = duration;
+         if (test["ci_width"])    cfg.ci_width = test["ci_width"].as<double>();
+         else                     cfg.ci_width = ci_width;
+         if (cfg.samples_auto && !cfg.duration) cfg.duration = DURATION_AUTO_DEFAULT;
+         // discarded warmup
+         if (test["warmup"])      cfg.warmup = ParseDuration(test["warmup"].as<std::string>());
+         else                     cfg.warmup = warmup;
+         if (test["warmup_samples"]) cfg.warmup_samples = test["warmup_samples"].as<size_t>();
+         else                     cfg.warmup_samples = warmup_samples;
+         // number of test function calls per sample
+         if (test["batch"])       cfg.batch = ParseBatch(test["batch"]);
+         else                     cfg.batch = batch;
+         // samples recording mode and histogram precision
+         if (test["recording"])   cfg.recording = ParseRecording(test["recording"].as<std::string>(), recording);
+         else                     cfg.recording = recording;
+         if (test["precision"])   cfg.precision = test["precision"].as<int>();
+         else                     cfg.precision = precision;
+         // binary trace of all samples
+         if (test["trace"])       cfg.trace = test["trace"].as<std::string>();
+         else                     cfg.trace = trace;
+         // status every second
+         if (test["progress"])    cfg.progress = test["progress"].as<bool>();
+         else                     cfg.progress = progress;
+         // time series of throughput and latency
+         if (test["window"])      cfg.window = ParseDuration(test["window"].as<std::string>());
+         else                     cfg.window = window;
+         if (test["window_threads"]) cfg.window_threads = test["window_threads"].as<bool>();
+         else                     cfg.window_threads = window_threads;
+         // samples buffer
+         if (test["ring"])        cfg.ring = test["ring"].as<size_t>();
+         else                     cfg.ring = ring;
+         cfg.pages = pages;
+         if (test["huge_pages"])  cfg.pages = test["huge_pages"].as<bool>() ? (cfg.pages | PAGES_HUGE)   : (cfg.pages & ~PAGES_HUGE);
+         if (test["lock_pages"])  cfg.pages = test["lock_pages"].as<bool>() ? (cfg.pages | PAGES_LOCKED) : (cfg.pages & ~PAGES_LOCKED);
+         // performance counters and counted region
+         if (test["counters"])    cfg.counters = ParseCounters(test["counters"]);
+         else                     cfg.counters = counters;
+         if (test["counters_scope"]) cfg.counters_scope = ParseCountersScope(test["counters_scope"].as<std::string>(), counters_scope);
+         else                     cfg.counters_scope = counters_scope;
+         // open-loop fixed rate of all threads
+         if (test["rate"])        cfg.rate = test["rate"].as<double>();
+         else                     cfg.rate = rate;
+         if (test["arrival"])     cfg.arrival = ParseArrival(test["arrival"].as<std::string>(), arrival);
+         else                     cfg.arrival = arrival;
+         // start of the measured part
+         if (test["start"])       cfg.start = ParseStart(test["start"].as<std::string>(), start);
+         else                     cfg.start = start;
+         if (test["start_spin"])  cfg.start_spin = ParseDuration(test["start_spin"].as<std::string>());
+         else                     cfg.start_spin = start_spin;
+         // work done by every call
+         if (test["items"])       cfg.items = test["items"].as<double>();
+         else                     cfg.items = items;
+         if (test["bytes"])       cfg.bytes = test["bytes"].as<double>();
+         else                     cfg.bytes = bytes;
+         // heap allocations of the measured calls
+         if (test["allocations"]) cfg.allocations = test["allocations"].as<bool>();
+         else                     cfg.allocations = allocations;
+         // every test in its own process
+         if (test["isolation"])   cfg.isolation = ParseIsolation(test["isolation"].as<std::string>(), isolation);
+         else                     cfg.isolation = isolation;
+         // worker processes
+         if (test["processes"])   cfg.processes = test["processes"].as<size_t>();
+         else                     cfg.processes = processes;
+         if (test["launch"])      cfg.launch = test["launch"].as<std::string>();
+         else                     cfg.launch = launch;
+         if (test["coordinator"]) cfg.coordinator = test["coordinator"].as<std::string>();
+         else                     cfg.coordinator = coordinator;
+         // threads placement
+         cfg.affinity      = affinity;
+         cfg.affinity_cpus = affinity_cpus;
+         cfg.affinity_offset = 0;
+         if (test["affinity"])    ParseAffinity(test["affinity"], cfg.affinity, cfg.affinity_cpus);
          // fix if there is some mistakes
          if (cfg.concurrency < 1) cfg.concurrency = 1;
          if (cfg.samples< 1)      cfg.samples     = 1;
+         if (cfg.batch < 1)       cfg.batch       = 1;
+         if (cfg.rate < 0)        cfg.rate        = 0;
+         if (cfg.processes < 1)   cfg.processes   = 1;
 
          // per-thread initialization strings
          if (test["threads"]) {
@@ -65,6 +240,7 @@ bool Benchmark::LoadConfig() {
                // check and fill the fields
                if (thread["init"])    t.initializer = thread["init"].as<std::string>();
                if (thread["context"]) t.context     = thread["context"].as<std::string>();
+               if (thread["cpu"])     t.cpu         = thread["cpu"].as<int>();
                // add new thread config
                cfg.threads.push_back(std::move(t));
             }
@@ -73,33 +249,664 @@ bool Benchmark::LoadConfig() {
          if (test["contexts"]) {
             for (const auto& context : test["contexts"]) {
                cfg.contexts[context["name"].as<std::string>()] = context["init"].as<std::string>();
+               // NUMA node of the context memory
+               if (context["node"])
+                  cfg.context_nodes[context["init"].as<std::string>()] = context["node"].as<int>();
             }
          }
+         if (test["context_init"] && test["context_node"])
+            cfg.context_nodes[cfg.thread_default.context] = test["context_node"].as<int>();
 
-         // add test to the list
+         return cfg;
+      };
+      // read tests configurations
+      for (const auto& test : config["tests"]) {
+         // tests of a group run simultaneously, each of them is also run alone before
+         if (test["group"]) {
+            TestCfg cfg{};
+            cfg.name = test["name"].as<std::string>();
+            cfg.solo = test["solo"] ? test["solo"].as<bool>() : true;
+            for (const auto& member : test["group"]) {
+               TestCfg member_cfg = parse_test(member);
+               if (!member_cfg.sweep.empty()) {
+                  std::cerr << "Config: concurrency sweep of group member \"" << member_cfg.name << "\" is ignored" << std::endl;
+                  member_cfg.sweep.clear();
+               }
+               // members share the threads of one process while running together
+               if (member_cfg.processes > 1) {
+                  std::cerr << "Config: worker processes of group member \"" << member_cfg.name << "\" are ignored" << std::endl;
+                  member_cfg.processes = 1;
+               }
+               cfg.group.emplace_back(std::move(member_cfg));
+            }
+            if (!cfg.group.empty()) m_tests.emplace_back(std::move(cfg));
+            continue;
+         }
+         // add test to the list, templated initializers expand to all parameter points
+         TestCfg cfg = parse_test(test);
+         if (test["params"]) ExpandParams(test["params"], cfg);
          m_tests.emplace_back(std::move(cfg));
       }
+
+      // interleaved comparisons of variants
+      for (const auto& group : config["compare"]) {
+         CompareCfg cfg;
+         cfg.name = group["name"].as<std::string>();
+         // number of concurrent threads, the first level of a global sweep
+         cfg.concurrency = concurrency[0];
+         if (group["concurrency"]) cfg.concurrency = group["concurrency"].as<size_t>();
+         // rounds and samples of every variant per round
+         cfg.rounds        = group["rounds"]  ? group["rounds"].as<size_t>()  : COMPARE_ROUNDS;
+         cfg.warmup_rounds = group["warmup_rounds"] ? group["warmup_rounds"].as<size_t>() : 1;
+         cfg.samples       = group["samples"] ? group["samples"].as<size_t>() : COMPARE_SAMPLES;
+         cfg.batch         = group["batch"]   ? ParseBatch(group["batch"])     : batch;
+         cfg.seed          = group["seed"]    ? group["seed"].as<uint64_t>()  : 1;
+         // threads placement
+         cfg.affinity      = affinity;
+         cfg.affinity_cpus = affinity_cpus;
+         if (group["affinity"]) ParseAffinity(group["affinity"], cfg.affinity, cfg.affinity_cpus);
+         // variants, the group init and load are defaults
+         for (const auto& variant : group["variants"]) {
+            CompareCfg::Variant v;
+            v.library     = variant["load"] ? variant["load"].as<std::string>() : group["load"].as<std::string>("");
+            v.initializer = variant["init"] ? variant["init"].as<std::string>() : group["init"].as<std::string>("");
+            v.context     = variant["context_init"] ? variant["context_init"].as<std::string>() : group["context_init"].as<std::string>("");
+            v.name        = variant["name"] ? variant["name"].as<std::string>() : (v.initializer.empty() ? v.library : v.initializer);
+            cfg.variants.push_back(std::move(v));
+         }
+         // fix if there is some mistakes
+         if (cfg.concurrency < 1) cfg.concurrency = 1;
+         if (cfg.rounds < 1)      cfg.rounds      = 1;
+         if (cfg.samples < 1)     cfg.samples     = 1;
+         if (cfg.batch < 1)       cfg.batch       = 1;
+         m_compares.emplace_back(std::move(cfg));
+      }
    }
    catch (const std::exception& e) {
       std::cerr << "Config parsing error: " << e.what() << "\n";
       return false;
    }
 
-   return m_tests.size() > 0;
+   return m_tests.size() > 0 || m_compares.size() > 0;
+}
+//+------------------------------------------------------------------+
+//| Cartesian product of parameter lists, every point is a test      |
+//| named "name[key=value,...]" with "{key}" substituted in its      |
+//| initializers                                                     |
+//+------------------------------------------------------------------+
+void Benchmark::ExpandParams(const YAML::Node& node, TestCfg& cfg) {
+   std::vector<std::pair<std::string, std::vector<std::string>>> lists;
+   for (const auto& param : node) {
+      std::vector<std::string> values;
+      if (param.second.IsSequence())
+         for (const auto& value : param.second) values.push_back(ParseParam(value.as<std::string>()));
+      else
+         values.push_back(ParseParam(param.second.as<std::string>()));
+      if (!values.empty()) lists.emplace_back(param.first.as<std::string>(), std::move(values));
+   }
+   if (lists.empty()) return;
+   if (!cfg.sweep.empty()) {
+      std::cerr << "Config: concurrency sweep of parameterized test \"" << cfg.name << "\" is ignored" << std::endl;
+      cfg.sweep.clear();
+   }
+
+   // points are copies of the test without the points list growing below
+   TestCfg base = cfg;
+   base.points.clear();
+   base.group.clear();
+   // odometer over the lists, the last parameter changes first
+   std::vector<size_t> index(lists.size(), 0);
+   for (bool done = false; !done;) {
+      TestCfg point = base;
+      for (size_t k = 0; k < lists.size(); k++)
+         point.params.emplace_back(lists[k].first, lists[k].second[index[k]]);
+      // test name with the point values
+      point.name += "[";
+      for (size_t k = 0; k < point.params.size(); k++)
+         point.name += (k ? "," : "") + point.params[k].first + "=" + point.params[k].second;
+      point.name += "]";
+      // initializers of the point
+      point.thread_default.initializer = Substitute(cfg.thread_default.initializer, point.params);
+      point.thread_default.context     = Substitute(cfg.thread_default.context, point.params);
+      for (auto& thread : point.threads) {
+         thread.initializer = Substitute(thread.initializer, point.params);
+         thread.context     = Substitute(thread.context, point.params);
+      }
+      for (auto& context : point.contexts) context.second = Substitute(context.second, point.params);
+      point.context_nodes.clear();
+      for (const auto& node_cfg : cfg.context_nodes)
+         point.context_nodes[Substitute(node_cfg.first, point.params)] = node_cfg.second;
+      cfg.points.emplace_back(std::move(point));
+      // next point
+      done = true;
+      for (size_t k = lists.size(); k-- > 0;) {
+         if (++index[k] < lists[k].second.size()) { done = false; break; }
+         index[k] = 0;
+      }
+   }
+}
+//+------------------------------------------------------------------+
+//| Normalize numeric parameter: "1K", "1M", "1G" are powers of      |
+//| 1024, "1e3" is decimal, integers are written in full, other      |
+//| values are kept as is                                            |
+//+------------------------------------------------------------------+
+std::string Benchmark::ParseParam(const std::string& value) {
+   if (value.empty()) return value;
+   double multiplier = 1;
+   size_t length     = value.size();
+   switch (value.back()) {
+      case 'k': case 'K': multiplier = 1024.0;                   length--; break;
+      case 'm': case 'M': multiplier = 1024.0 * 1024;            length--; break;
+      case 'g': case 'G': multiplier = 1024.0 * 1024 * 1024;     length--; break;
+      case 't': case 'T': multiplier = 1024.0 * 1024 * 1024 * 1024; length--; break;
+   }
+   std::string number = value.substr(0, length);
+   char*       end    = NULL;
+   double      result = strtod(number.c_str(), &end);
+   if (number.empty() || !end || *end != 0 || !std::isfinite(result)) return value;
+   result *= multiplier;
+   // integers without exponent, fractions with the shortest form
+   if (result == std::floor(result) && std::fabs(result) < 9.2e18)
+      return std::to_string(int64_t(result));
+   std::ostringstream oss;
+   oss << result;
+   return oss.str();
+}
+//+------------------------------------------------------------------+
+//| Replace "{key}" with the parameter values                        |
+//+------------------------------------------------------------------+
+std::string Benchmark::Substitute(const std::string& value, const TestCfg::Params& params) {
+   std::string res = value;
+   for (const auto& param : params) {
+      std::string key = "{" + param.first + "}";
+      for (size_t pos = 0; (pos = res.find(key, pos)) != std::string::npos; pos += param.second.size())
+         res.replace(pos, key.size(), param.second);
+   }
+   return res;
+}
+//+------------------------------------------------------------------+
+//| Parse samples recording mode                                     |
+//+------------------------------------------------------------------+
+EnRecording Benchmark::ParseRecording(const std::string& name, EnRecording def) {
+   if (name == "samples")   return RECORDING_SAMPLES;
+   if (name == "histogram") return RECORDING_HISTOGRAM;
+   std::cerr << "Config: unknown recording \"" << name << "\"" << std::endl;
+   return def;
+}
+//+------------------------------------------------------------------+
+//| Parse list of performance counters to the mask                   |
+//+------------------------------------------------------------------+
+uint32_t Benchmark::ParseCounters(const YAML::Node& node) {
+   uint32_t mask = 0;
+   for (const auto& item : node) {
+      std::string name = item.as<std::string>();
+      EnCounter   counter;
+      if (PerfCounters::Parse(name, counter)) mask |= PerfCounters::Mask(counter);
+      else std::cerr << "Config: unknown counter \"" << name << "\"" << std::endl;
+   }
+   return mask;
+}
+//+------------------------------------------------------------------+
+//| Parse counted region                                             |
+//+------------------------------------------------------------------+
+EnCounterScope Benchmark::ParseCountersScope(const std::string& name, EnCounterScope def) {
+   if (name == "loop")   return COUNTERS_SCOPE_LOOP;
+   if (name == "sample") return COUNTERS_SCOPE_SAMPLE;
+   std::cerr << "Config: unknown counters scope \"" << name << "\"" << std::endl;
+   return def;
+}
+//+------------------------------------------------------------------+
+//| Parse concurrency: number, list of numbers, "1..N", "1..N step k"|
+//| (linear) or "1..N x2" (geometric)                                |
+//+------------------------------------------------------------------+
+std::vector<size_t> Benchmark::ParseConcurrency(const YAML::Node& node) {
+   std::vector<size_t> levels;
+   if (node.IsSequence()) {
+      for (const auto& level : node)
+         levels.push_back(level.as<size_t>());
+   }
+   else {
+      std::string value = node.as<std::string>();
+      size_t      range = value.find("..");
+      if (range == std::string::npos)
+         levels.push_back(node.as<size_t>());
+      else {
+         size_t first = 0, last = 0, step = 1, factor = 1;
+         char   kind[8] = {};
+         int    fields = sscanf(value.c_str(), "%zu..%zu %7s %zu", &first, &last, kind, &step);
+         if (fields == 3 && kind[0] == 'x') {
+            // "x2" written together
+            factor = strtoul(kind + 1, NULL, 10);
+         }
+         else if (fields == 4 && strcmp(kind, "x") == 0) {
+            factor = step;
+         }
+         else if (fields != 2 && !(fields == 4 && strcmp(kind, "step") == 0)) {
+            std::cerr << "Config: invalid concurrency \"" << value << "\"" << std::endl;
+            return levels;
+         }
+         if (first < 1) first = 1;
+         if (step < 1)  step  = 1;
+         for (size_t n = first; n <= last; n = factor > 1 ? n * factor : n + step)
+            levels.push_back(n);
+      }
+   }
+   // zero threads are fixed to one
+   for (auto& level : levels)
+      if (level < 1) level = 1;
+   return levels;
+}
+//+------------------------------------------------------------------+
+//| Parse threads placement: policy name or list of CPUs             |
+//+------------------------------------------------------------------+
+void Benchmark::ParseAffinity(const YAML::Node& node, EnAffinity& affinity, std::vector<int>& cpus) {
+   if (node.IsSequence()) {
+      affinity = AFFINITY_LIST;
+      cpus.clear();
+      for (const auto& cpu : node)
+         cpus.push_back(cpu.as<int>());
+      return;
+   }
+   std::string name = node.as<std::string>();
+   if (!Topology::Parse(name, affinity))
+      std::cerr << "Config: unknown affinity \"" << name << "\"" << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Parse samples count or "auto"                                    |
+//+------------------------------------------------------------------+
+void Benchmark::ParseSamples(const YAML::Node& node, size_t& samples, bool& samples_auto) {
+   std::string value = node.as<std::string>();
+   samples_auto = value == "auto";
+   if (!samples_auto) samples = node.as<size_t>();
+}
+//+------------------------------------------------------------------+
+//| Parse calls per sample, signed to catch negative values          |
+//+------------------------------------------------------------------+
+size_t Benchmark::ParseBatch(const YAML::Node& node) {
+   long long batch = node.as<long long>();
+   if (batch < 1) {
+      std::cerr << "Config: batch " << batch << " is less than 1, 1 is used" << std::endl;
+      return 1;
+   }
+   return size_t(batch);
+}
+//+------------------------------------------------------------------+
+//| Parse duration "10s", "500ms", "100us", "50ns", "2m" or seconds  |
+//+------------------------------------------------------------------+
+uint64_t Benchmark::ParseDuration(const std::string& value) {
+   static const struct { const char* suffix; double ns; } units[] = {
+      { "ns", 1.0 }, { "us", 1e3 }, { "ms", 1e6 }, { "s", 1e9 }, { "m", 60e9 }, { "h", 3600e9 }
+   };
+   size_t pos    = 0;
+   double number = 0;
+   try {
+      number = std::stod(value, &pos);
+   }
+   catch (const std::exception&) {
+      std::cerr << "Config: invalid duration \"" << value << "\"" << std::endl;
+      return 0;
+   }
+   // number without suffix is in seconds
+   std::string suffix = value.substr(pos);
+   suffix.erase(0, suffix.find_first_not_of(' '));
+   if (suffix.empty()) return uint64_t(number * 1e9);
+   for (const auto& unit : units)
+      if (suffix == unit.suffix) return uint64_t(number * unit.ns);
+   std::cerr << "Config: unknown duration unit \"" << value << "\"" << std::endl;
+   return 0;
+}
+//+------------------------------------------------------------------+
+//| Parse samples arrival of the fixed rate mode                     |
+//+------------------------------------------------------------------+
+EnArrival Benchmark::ParseArrival(const std::string& name, EnArrival def) {
+   if (name == "constant") return ARRIVAL_CONSTANT;
+   if (name == "poisson")  return ARRIVAL_POISSON;
+   std::cerr << "Config: unknown arrival \"" << name << "\"" << std::endl;
+   return def;
+}
+//+------------------------------------------------------------------+
+//| Parse start of the measured part                                 |
+//+------------------------------------------------------------------+
+EnStart Benchmark::ParseStart(const std::string& name, EnStart def) {
+   if (name == "barrier") return START_BARRIER;
+   if (name == "spin")    return START_SPIN;
+   std::cerr << "Config: unknown start \"" << name << "\"" << std::endl;
+   return def;
+}
+//+------------------------------------------------------------------+
+//| Parse test execution environment                                 |
+//+------------------------------------------------------------------+
+EnIsolation Benchmark::ParseIsolation(const std::string& name, EnIsolation def) {
+   if (name == "none")    return ISOLATION_NONE;
+   if (name == "process") {
+      if (Isolation::Supported()) return ISOLATION_PROCESS;
+      std::cerr << "Config: isolation \"process\" is not supported on this platform, tests run in the Bench process" << std::endl;
+      return ISOLATION_NONE;
+   }
+   std::cerr << "Config: unknown isolation \"" << name << "\"" << std::endl;
+   return def;
 }
 //+------------------------------------------------------------------+
 //| Run tests                                                        |
 //+------------------------------------------------------------------+
-void Benchmark::Run() {
+int Benchmark::Run() {
+   // calibrate clock once for all tests
+   ExtClock.Initialize(m_clock, m_clock_subtract);
+   ExtClock.Print();
+   // CPUs available for threads placement
+   if (ExtTopology.Load()) ExtTopology.Print();
+   // part of a multi-process test
+   if (!m_worker.empty()) return RunWorker();
+
    for (auto& cfg : m_tests) {
-      Test test;
-      // initialize test
-      if (test.Initialize(cfg)) {
-         // run test
-         test.Run();
-         // calculate, show and store statistics
-         test.ProcessStatistics();
+      // the rest of tests are skipped after Ctrl+C
+      if (ExtStop) break;
+      if (!cfg.group.empty()) {
+         RunGroup(cfg, m_summaries);
+         continue;
+      }
+      if (!cfg.points.empty()) {
+         RunMatrix(cfg, m_summaries);
+         continue;
       }
+      if (cfg.sweep.empty()) {
+         TestSummary summary{};
+         RunTest(cfg, &summary);
+         if (summary.threads) m_summaries.push_back(summary);
+         continue;
+      }
+      // fresh test instances for every concurrency level
+      std::vector<TestSummary> results;
+      for (size_t level : cfg.sweep) {
+         if (ExtStop) break;
+         TestCfg     level_cfg = cfg;
+         TestSummary summary{};
+         level_cfg.concurrency = level;
+         level_cfg.name        = cfg.name + "@" + std::to_string(level);
+         RunTest(level_cfg, &summary);
+         if (summary.threads) results.push_back(summary);
+      }
+      PrintSweep(cfg, results);
+      m_summaries.insert(m_summaries.end(), results.begin(), results.end());
+   }
+   for (const auto& cfg : m_compares) {
+      if (ExtStop) break;
+      RunCompare(cfg);
+   }
+
+   // store results and check them against the baseline
+   if (!m_results.empty() && !m_summaries.empty())
+      Results::Write(Test::ResolvePath(m_results, ""), m_summaries);
+   if (!m_baseline.empty()) {
+      int regressions = Results::Compare(m_baseline, m_summaries, m_threshold, Results::ALPHA_DEFAULT);
+      if (regressions < 0) return 2;
+      if (regressions > 0) {
+         std::cout << regressions << " regression(s) found" << std::endl;
+         return 1;
+      }
+   }
+   return 0;
+}
+//+------------------------------------------------------------------+
+//| Worker process of a test started by the coordinator              |
+//+------------------------------------------------------------------+
+int Benchmark::RunWorker() {
+   // the test is a configured one, its concurrency level or matrix point
+   for (const auto& cfg : m_tests) {
+      if (cfg.name == m_worker_test)
+         return Coordinator::RunWorker(cfg, m_worker, m_worker_index);
+      for (size_t level : cfg.sweep)
+         if (cfg.name + "@" + std::to_string(level) == m_worker_test) {
+            TestCfg level_cfg = cfg;
+            level_cfg.concurrency = level;
+            level_cfg.name        = m_worker_test;
+            return Coordinator::RunWorker(level_cfg, m_worker, m_worker_index);
+         }
+      for (const auto& point : cfg.points)
+         if (point.name == m_worker_test)
+            return Coordinator::RunWorker(point, m_worker, m_worker_index);
+   }
+   std::cerr << "Worker: test \"" << m_worker_test << "\" not found in the config" << std::endl;
+   return 1;
+}
+//+------------------------------------------------------------------+
+//| Run single test configuration                                    |
+//+------------------------------------------------------------------+
+void Benchmark::RunTest(const TestCfg& cfg, TestSummary* summary) {
+   if (cfg.processes > 1) {
+      if (!Coordinator::Supported()) {
+         std::cerr << "Test \"" << cfg.name << "\" worker processes are not supported on this platform, the test runs in the Bench process" << std::endl;
+         RunInProcess(cfg, summary);
+         return;
+      }
+      Coordinator::Run(cfg, summary);
+      return;
+   }
+   if (cfg.isolation == ISOLATION_PROCESS) {
+      TestSummary result{};
+      // the configuration stays in the parent, the child sends statistics only
+      if (Isolation::Run(cfg.name, [&cfg](TestSummary& child) { RunInProcess(cfg, &child); }, result)) {
+         result.cfg = cfg;
+         if (summary) *summary = result;
+      }
+      return;
+   }
+   RunInProcess(cfg, summary);
+}
+//+------------------------------------------------------------------+
+//| Run single test configuration in the Bench process               |
+//+------------------------------------------------------------------+
+void Benchmark::RunInProcess(const TestCfg& cfg, TestSummary* summary) {
+   Test test;
+   // initialize and run test
+   if (test.Initialize(cfg) && test.Run()) {
+      // calculate, show and store statistics
+      test.ProcessStatistics();
+      // save all samples for post-analysis
+      test.SaveTrace();
+      // results for the caller
+      if (summary) *summary = test.Summary();
+   }
+}
+//+------------------------------------------------------------------+
+//| Run every parameter point                                        |
+//+------------------------------------------------------------------+
+void Benchmark::RunMatrix(const TestCfg& cfg, std::vector<TestSummary>& results) {
+   std::vector<TestSummary> points(cfg.points.size());
+   for (size_t i = 0; i < cfg.points.size() && !ExtStop; i++) {
+      RunTest(cfg.points[i], &points[i]);
+      if (points[i].threads) results.push_back(points[i]);
+   }
+   PrintMatrix(cfg, points);
+}
+//+------------------------------------------------------------------+
+//| Print table of parameter points                                  |
+//+------------------------------------------------------------------+
+void Benchmark::PrintMatrix(const TestCfg& cfg, const std::vector<TestSummary>& results) {
+   // column of every parameter fits its name and values
+   std::vector<size_t> widths;
+   for (const auto& param : cfg.points[0].params) widths.push_back(param.first.size());
+   for (const auto& point : cfg.points)
+      for (size_t k = 0; k < point.params.size() && k < widths.size(); k++)
+         widths[k] = std::max(widths[k], point.params[k].second.size());
+
+   std::cout << "======================================================================================" << std::endl;
+   std::cout << "Test \"" << cfg.name << "\" parameters, per call:" << std::endl;
+   std::cout << " ";
+   for (size_t k = 0; k < widths.size(); k++)
+      std::cout << " " << std::setw(int(widths[k])) << std::right << cfg.points[0].params[k].first;
+   std::cout << std::setw(8) << "threads" << std::setw(12) << "med" << std::setw(12) << "p90" << std::setw(12) << "p99"
+             << std::setw(14) << "calls/s" << std::setw(10) << "med x" << std::endl;
+   double reference = 0;
+   for (size_t i = 0; i < cfg.points.size(); i++) {
+      const TestSummary& r = results[i];
+      std::cout << " ";
+      for (size_t k = 0; k < widths.size(); k++)
+         std::cout << " " << std::setw(int(widths[k])) << std::right << cfg.points[i].params[k].second;
+      if (!r.threads || !r.stats.count) {
+         std::cout << std::setw(8) << "-" << "  no results" << std::endl;
+         continue;
+      }
+      // per call values, growth relative to the first point
+      double batch = double(r.batch), med = r.stats.med / batch;
+      if (reference == 0) reference = med;
+      std::cout << std::setw(8)  << r.threads
+                << std::setw(12) << Test::FormatDuration(med)
+                << std::setw(12) << Test::FormatDuration(r.stats.p90 / batch)
+                << std::setw(12) << Test::FormatDuration(r.stats.p99 / batch)
+                << std::setw(14) << std::fixed << std::setprecision(0) << r.throughput
+                << std::setw(10) << std::setprecision(2) << (reference > 0 ? med / reference : 0) << std::defaultfloat << std::endl;
+   }
+}
+//+------------------------------------------------------------------+
+//| Run group members alone, then all of them simultaneously behind  |
+//| a shared start barrier                                           |
+//+------------------------------------------------------------------+
+void Benchmark::RunGroup(const TestCfg& cfg, std::vector<TestSummary>& results) {
+   std::vector<TestSummary> solo(cfg.group.size()), group(cfg.group.size());
+   // reference results of every member without the others, named "group/member@solo"
+   if (cfg.solo) {
+      for (size_t i = 0; i < cfg.group.size() && !ExtStop; i++) {
+         TestCfg member = cfg.group[i];
+         member.name = cfg.name + "/" + member.name + "@solo";
+         RunTest(member, &solo[i]);
+         if (solo[i].threads) results.push_back(solo[i]);
+      }
+   }
+   if (ExtStop) return;
+
+   // members are named "group/member"
+   std::vector<Test*> tests(cfg.group.size(), NULL);
+   size_t             threads = 0;
+   bool               warmup  = false;
+   std::map<EnAffinity, size_t> offsets;
+   for (size_t i = 0; i < cfg.group.size(); i++) {
+      TestCfg member = cfg.group[i];
+      member.name = cfg.name + "/" + member.name;
+      // members of the same placement share one layout, each takes its own CPUs
+      member.affinity_offset      = offsets[member.affinity];
+      offsets[member.affinity]   += member.concurrency;
+      tests[i] = new Test();
+      if (!tests[i]->Initialize(member)) {
+         delete tests[i];
+         tests[i] = NULL;
+         continue;
+      }
+      threads += tests[i]->Threads();
+      warmup  |= tests[i]->HasWarmup();
+   }
+   // every thread of every member waits at the same barrier
+   if (threads) {
+      std::barrier sync_point(threads + 1);
+      std::cout << "Group \"" << cfg.name << "\" started: " << threads << " threads" << std::endl;
+      for (auto test : tests)
+         if (test) test->Launch(sync_point, warmup);
+      sync_point.arrive_and_wait();
+      // measured parts start after warmup of all members
+      if (warmup) sync_point.arrive_and_wait();
+      // spinning members share one deadline, taken before any of them is started
+      uint64_t spin = 0;
+      for (size_t i = 0; i < tests.size(); i++)
+         if (tests[i] && cfg.group[i].start == START_SPIN) spin = std::max(spin, cfg.group[i].start_spin);
+      uint64_t deadline = spin ? ClockSteady::Start() + spin : 0;
+      for (auto test : tests)
+         if (test) test->Started(deadline);
+      for (auto& test : tests)
+         if (test && !test->Join()) {
+            delete test;
+            test = NULL;
+         }
+      // statistics of every member
+      for (size_t i = 0; i < tests.size(); i++) {
+         if (!tests[i]) continue;
+         tests[i]->ProcessStatistics();
+         tests[i]->SaveTrace();
+         group[i] = tests[i]->Summary();
+         if (group[i].threads) results.push_back(group[i]);
+      }
+   }
+   for (auto test : tests) delete test;
+   PrintGroup(cfg, solo, group);
+}
+//+------------------------------------------------------------------+
+//| Print slowdown of every member caused by the other members       |
+//+------------------------------------------------------------------+
+void Benchmark::PrintGroup(const TestCfg& cfg, const std::vector<TestSummary>& solo, const std::vector<TestSummary>& group) {
+   if (!cfg.solo) return;
+   std::cout << "Group \"" << cfg.name << "\" interference, alone -> together, per call:" << std::endl;
+   for (size_t i = 0; i < cfg.group.size(); i++) {
+      const TestSummary& a = solo[i];
+      const TestSummary& b = group[i];
+      std::cout << "  [" << cfg.group[i].name << "] ";
+      if (!a.threads || !b.threads || !a.stats.count || !b.stats.count) {
+         std::cout << "no results" << std::endl;
+         continue;
+      }
+      double med_a = double(a.stats.med) / double(a.batch), med_b = double(b.stats.med) / double(b.batch);
+      double p99_a = double(a.stats.p99) / double(a.batch), p99_b = double(b.stats.p99) / double(b.batch);
+      std::cout << "med " << Test::FormatDuration(med_a) << " -> " << Test::FormatDuration(med_b)
+                << std::fixed << std::setprecision(2) << " (x" << (med_a > 0 ? med_b / med_a : 0) << ")"
+                << ", p99 " << Test::FormatDuration(p99_a) << " -> " << Test::FormatDuration(p99_b)
+                << " (x" << (p99_a > 0 ? p99_b / p99_a : 0) << ")"
+                << std::setprecision(0) << ", throughput " << a.throughput << " -> " << b.throughput << " calls/s"
+                << std::showpos << std::setprecision(1) << " (" << (a.throughput > 0 ? (b.throughput / a.throughput - 1.0) * 100.0 : 0) << "%)"
+                << std::noshowpos << std::defaultfloat << std::endl;
+   }
+}
+//+------------------------------------------------------------------+
+//| Run interleaved comparison of variants                           |
+//+------------------------------------------------------------------+
+void Benchmark::RunCompare(const CompareCfg& cfg) {
+   Comparison compare;
+   if (compare.Initialize(cfg)) {
+      compare.Run();
+      compare.ProcessStatistics();
+   }
+}
+//+------------------------------------------------------------------+
+//| Print throughput and latency of concurrency levels, fit USL      |
+//+------------------------------------------------------------------+
+void Benchmark::PrintSweep(const TestCfg& cfg, const std::vector<TestSummary>& results) {
+   if (results.empty()) return;
+   // scalability is relative to the smallest level throughput per thread
+   const TestSummary& base = *std::min_element(results.begin(), results.end(),
+                                               [](const TestSummary& a, const TestSummary& b) { return a.threads < b.threads; });
+   double per_thread = base.throughput / double(base.threads);
+
+   std::cout << "Test \"" << cfg.name << "\" concurrency sweep:" << std::endl;
+   std::cout << "  threads      calls/s  speedup  efficiency         p50         p90         p99       p99.9" << std::endl;
+   for (const auto& r : results) {
+      double batch   = double(r.batch);
+      double speedup = per_thread > 0 ? r.throughput / per_thread : 0;
+      std::cout << "  " << std::setw(7) << std::right << r.threads
+                << std::fixed << std::setprecision(0) << std::setw(13) << r.throughput
+                << std::setprecision(2) << std::setw(9) << speedup
+                << std::setw(11) << speedup * 100.0 / double(r.threads) << "%" << std::defaultfloat
+                << std::setw(12) << Test::FormatDuration(r.stats.med  / batch)
+                << std::setw(12) << Test::FormatDuration(r.stats.p90  / batch)
+                << std::setw(12) << Test::FormatDuration(r.stats.p99  / batch)
+                << std::setw(12) << Test::FormatDuration(r.stats.p999 / batch) << std::endl;
+   }
+
+   // Universal Scalability Law
+   std::vector<size_t> levels;
+   std::vector<double> throughput;
+   for (const auto& r : results) {
+      levels.push_back(r.threads);
+      throughput.push_back(r.throughput);
+   }
+   double sigma, kappa, lambda;
+   if (Statistics::FitUSL(levels.data(), throughput.data(), results.size(), sigma, kappa, lambda)) {
+      std::cout << "  USL: contention sigma = " << std::setprecision(4) << sigma
+                << ", coherency kappa = " << kappa
+                << ", single thread " << std::fixed << std::setprecision(0) << lambda << " calls/s" << std::defaultfloat;
+      // throughput peaks at sqrt((1-sigma)/kappa) threads
+      if (kappa > 0 && sigma < 1)
+         std::cout << ", peak at " << std::setprecision(1) << std::fixed << std::sqrt((1 - sigma) / kappa) << " threads" << std::defaultfloat;
+      std::cout << std::endl;
    }
+   else
+      std::cout << "  USL: at least 3 concurrency levels are required" << std::endl;
+   std::cout << "======================================================================================" << std::endl;
 }
 //+------------------------------------------------------------------+
@@ -5,21 +5,72 @@
 //+------------------------------------------------------------------+
 #pragma once
 #include "Test.h"
+#include "Results.h"
+#include "Comparison.h"
+#include "Isolation.h"
+#include "Coordinator.h"
+
+namespace YAML { class Node; }
 
 //+------------------------------------------------------------------+
 //|                                                                  |
 //+------------------------------------------------------------------+
 class Benchmark {
-   typedef std::vector<TestCfg> TConfigs;
+   typedef std::vector<TestCfg>    TConfigs;
+   typedef std::vector<CompareCfg> TCompares;
 
 private:
    TConfigs          m_tests;
+   TCompares         m_compares;
+   EnClock           m_clock;
+   bool              m_clock_subtract;
+   std::string       m_results;              // results file path, empty to disable
+   std::string       m_baseline;             // baseline results to compare with, empty to disable
+   double            m_threshold;            // regression threshold, relative median change
+   Results::TSummaries m_summaries;          // results of all runs
+   std::string       m_worker;               // coordinator address in the worker mode, empty otherwise
+   std::string       m_worker_test;          // test name of the worker
+   size_t            m_worker_index;         // worker process index
 
 public:
                      Benchmark();
                     ~Benchmark();
 
+   static constexpr uint64_t DURATION_AUTO_DEFAULT = 60'000'000'000ull; // time cap of samples: auto
+   static constexpr double   CI_WIDTH_DEFAULT      = 0.01;                // 1% of the median
+   static constexpr size_t   COMPARE_ROUNDS        = 20;                  // measured rounds of compare groups
+   static constexpr size_t   COMPARE_SAMPLES       = 10'000;              // samples of every variant per round
+   static constexpr uint64_t START_SPIN_DEFAULT    = 1'000'000;           // spin before the start: spin deadline
+
    bool              LoadConfig();
-   void              Run();
+   // returns process exit code, non-zero on regression against the baseline
+   int               Run();
+   void              SetBaseline(const std::string& path, double threshold) { m_baseline = path; m_threshold = threshold; }
+   void              SetWorker(const std::string& address, const std::string& test, size_t index) { m_worker = address; m_worker_test = test; m_worker_index = index; }
+
+private:
+   static EnRecording ParseRecording(const std::string& name, EnRecording def);
+   static uint32_t   ParseCounters(const YAML::Node& node);
+   static EnCounterScope ParseCountersScope(const std::string& name, EnCounterScope def);
+   static EnArrival  ParseArrival(const std::string& name, EnArrival def);
+   static EnStart    ParseStart(const std::string& name, EnStart def);
+   static EnIsolation ParseIsolation(const std::string& name, EnIsolation def);
+   static uint64_t   ParseDuration(const std::string& value);
+   static size_t     ParseBatch(const YAML::Node& node);
+   static void       ParseSamples(const YAML::Node& node, size_t& samples, bool& samples_auto);
+   static std::vector<size_t> ParseConcurrency(const YAML::Node& node);
+   static std::string ParseParam(const std::string& value);
+   static std::string Substitute(const std::string& value, const TestCfg::Params& params);
+   static void       ExpandParams(const YAML::Node& node, TestCfg& cfg);
+   static void       ParseAffinity(const YAML::Node& node, EnAffinity& affinity, std::vector<int>& cpus);
+   static void       RunTest(const TestCfg& cfg, TestSummary* summary);
+   int               RunWorker();
+   static void       RunInProcess(const TestCfg& cfg, TestSummary* summary);
+   static void       RunCompare(const CompareCfg& cfg);
+   static void       RunGroup(const TestCfg& cfg, std::vector<TestSummary>& results);
+   static void       RunMatrix(const TestCfg& cfg, std::vector<TestSummary>& results);
+   static void       PrintMatrix(const TestCfg& cfg, const std::vector<TestSummary>& results);
+   static void       PrintGroup(const TestCfg& cfg, const std::vector<TestSummary>& solo, const std::vector<TestSummary>& group);
+   static void       PrintSweep(const TestCfg& cfg, const std::vector<TestSummary>& results);
 };
 //+------------------------------------------------------------------+
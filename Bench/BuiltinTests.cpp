@@ -0,0 +1,18 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "TestRunner.h"
+
+//+------------------------------------------------------------------+
+//| Empty test, the loop overhead without a vtable call.             |
+//| Compare with the "empty" plugin to see the cost of the plugin    |
+//| call                                                             |
+//+------------------------------------------------------------------+
+class Empty {
+public:
+   int               Run() { return true; }
+};
+BENCH_REGISTER(Empty);
+//+------------------------------------------------------------------+
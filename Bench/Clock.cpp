@@ -0,0 +1,165 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "Clock.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#ifdef BENCH_X86
+#ifndef _MSC_VER
+#include <cpuid.h>
+#endif
+#endif
+
+// global variable
+Clock ExtClock;
+//+------------------------------------------------------------------+
+//| Initialization                                                   |
+//+------------------------------------------------------------------+
+Clock::Clock() : m_type(CLOCK_TYPE_STEADY), m_frequency(1e9), m_ns_per_tick(1.0),
+                 m_overhead(0), m_subtract(false), m_invariant(false) {
+}
+//+------------------------------------------------------------------+
+//| Select clock, calibrate its frequency and probe overhead         |
+//+------------------------------------------------------------------+
+bool Clock::Initialize(EnClock type, bool subtract) {
+   m_type       = type;
+   m_subtract   = subtract;
+   m_frequency  = 1e9;
+   m_ns_per_tick= 1.0;
+   m_overhead   = 0;
+   m_invariant  = false;
+
+   switch (m_type) {
+      case CLOCK_TYPE_STEADY:
+         m_overhead = MeasureOverhead<ClockSteady>();
+         return true;
+#ifdef _WIN32
+      case CLOCK_TYPE_QPC: {
+         LARGE_INTEGER freq;
+         QueryPerformanceFrequency(&freq);
+         m_frequency  = double(freq.QuadPart);
+         m_ns_per_tick= 1e9 / m_frequency;
+         m_overhead   = MeasureOverhead<ClockQpc>();
+         return true;
+      }
+#else
+      case CLOCK_TYPE_MONOTONIC_RAW:
+         m_overhead = MeasureOverhead<ClockMonotonicRaw>();
+         return true;
+#endif
+#ifdef BENCH_X86
+      case CLOCK_TYPE_TSC:
+         if (!CalibrateTsc()) break;
+         m_overhead = MeasureOverhead<ClockTsc>();
+         return true;
+      case CLOCK_TYPE_TSCP:
+         if (!CalibrateTsc()) break;
+         m_overhead = MeasureOverhead<ClockTscp>();
+         return true;
+#endif
+      default:
+         break;
+   }
+
+   // clock is not available on this platform, fall back to the steady clock
+   std::cerr << "Clock \"" << Name(type) << "\" is not available, \"" << Name(CLOCK_TYPE_STEADY) << "\" is used" << std::endl;
+   m_type     = CLOCK_TYPE_STEADY;
+   m_overhead = MeasureOverhead<ClockSteady>();
+   return false;
+}
+//+------------------------------------------------------------------+
+//| Print clock parameters                                           |
+//+------------------------------------------------------------------+
+void Clock::Print() const {
+   std::cout << "Clock \"" << Name(m_type) << "\": " << std::fixed << std::setprecision(3)
+             << m_frequency / 1e9 << " GHz"
+             << ((m_type == CLOCK_TYPE_TSC || m_type == CLOCK_TYPE_TSCP) ? (m_invariant ? ", invariant" : ", NOT invariant") : "")
+             << ", probe overhead " << m_overhead << " ns"
+             << (m_subtract ? " (subtracted)" : " (not subtracted)")
+             << std::defaultfloat << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Platform default clock                                           |
+//+------------------------------------------------------------------+
+EnClock Clock::Default() {
+#ifdef _WIN32
+   return CLOCK_TYPE_QPC;
+#else
+   return CLOCK_TYPE_MONOTONIC_RAW;
+#endif
+}
+//+------------------------------------------------------------------+
+//| Parse clock name                                                 |
+//+------------------------------------------------------------------+
+bool Clock::Parse(const std::string& name, EnClock& type) {
+   if (name == "steady")        { type = CLOCK_TYPE_STEADY;        return true; }
+   if (name == "qpc")           { type = CLOCK_TYPE_QPC;           return true; }
+   if (name == "monotonic_raw") { type = CLOCK_TYPE_MONOTONIC_RAW; return true; }
+   if (name == "tsc")           { type = CLOCK_TYPE_TSC;           return true; }
+   if (name == "tscp")          { type = CLOCK_TYPE_TSCP;          return true; }
+   return false;
+}
+//+------------------------------------------------------------------+
+//| Clock name                                                       |
+//+------------------------------------------------------------------+
+const char* Clock::Name(EnClock type) {
+   switch (type) {
+      case CLOCK_TYPE_STEADY:        return "steady";
+      case CLOCK_TYPE_QPC:           return "qpc";
+      case CLOCK_TYPE_MONOTONIC_RAW: return "monotonic_raw";
+      case CLOCK_TYPE_TSC:           return "tsc";
+      case CLOCK_TYPE_TSCP:          return "tscp";
+   }
+   return "unknown";
+}
+//+------------------------------------------------------------------+
+//| Minimal cost of an empty Start/Stop probe in nanoseconds         |
+//+------------------------------------------------------------------+
+template<class TClock>
+uint64_t Clock::MeasureOverhead() const {
+   constexpr size_t probes = 100'000;
+   uint64_t overhead = UINT64_MAX;
+   // the minimum is what the timer alone adds to every sample
+   for (size_t i = 0; i < probes; i++) {
+      uint64_t start = TClock::Start();
+      uint64_t end   = TClock::Stop();
+      if (end - start < overhead) overhead = end - start;
+   }
+   return ToNs(overhead);
+}
+//+------------------------------------------------------------------+
+//| Measure TSC frequency against the steady clock                   |
+//+------------------------------------------------------------------+
+bool Clock::CalibrateTsc() {
+#ifdef BENCH_X86
+   // check invariant TSC support, CPUID.80000007H:EDX[8]
+   unsigned regs[4] = {};
+#ifdef _MSC_VER
+   __cpuid(reinterpret_cast<int*>(regs), 0x80000007);
+#else
+   __get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+   m_invariant = (regs[3] & (1u << 8)) != 0;
+   if (!m_invariant)
+      std::cerr << "Warning: TSC is not invariant, timings depend on CPU frequency" << std::endl;
+
+   // take ticks and nanoseconds over the same 200 ms interval
+   auto     start_time = std::chrono::steady_clock::now();
+   uint64_t start_tsc  = ClockTsc::Start();
+   std::this_thread::sleep_for(std::chrono::milliseconds(200));
+   uint64_t end_tsc    = ClockTsc::Start();
+   auto     end_time   = std::chrono::steady_clock::now();
+
+   double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+   if (ns <= 0 || end_tsc <= start_tsc) return false;
+   m_frequency  = (end_tsc - start_tsc) * 1e9 / ns;
+   m_ns_per_tick= ns / (end_tsc - start_tsc);
+   return true;
+#else
+   return false;
+#endif
+}
+//+------------------------------------------------------------------+
@@ -0,0 +1,104 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include "Platform.h"
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BENCH_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+//+------------------------------------------------------------------+
+//| Clock backends                                                   |
+//+------------------------------------------------------------------+
+enum EnClock {
+   CLOCK_TYPE_STEADY,                        // std::chrono::steady_clock
+   CLOCK_TYPE_QPC,                           // QueryPerformanceCounter, Windows only
+   CLOCK_TYPE_MONOTONIC_RAW,                 // clock_gettime(CLOCK_MONOTONIC_RAW), POSIX only
+   CLOCK_TYPE_TSC,                           // lfence + rdtsc + lfence
+   CLOCK_TYPE_TSCP,                          // rdtscp + lfence, x86 only
+};
+//+------------------------------------------------------------------+
+//| Each backend reads raw ticks at the start and at the end of the  |
+//| measured region, ticks are converted to nanoseconds after run    |
+//+------------------------------------------------------------------+
+struct ClockSteady {
+   static uint64_t Start() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+   static uint64_t Stop()  { return Start(); }
+};
+#ifdef _WIN32
+struct ClockQpc {
+   static uint64_t Start() { LARGE_INTEGER qpc; QueryPerformanceCounter(&qpc); return qpc.QuadPart; }
+   static uint64_t Stop()  { return Start(); }
+};
+#else
+struct ClockMonotonicRaw {
+   static uint64_t Start() { timespec ts; clock_gettime(CLOCK_MONOTONIC_RAW, &ts); return uint64_t(ts.tv_sec) * 1'000'000'000ull + ts.tv_nsec; }
+   static uint64_t Stop()  { return Start(); }
+};
+#endif
+#ifdef BENCH_X86
+struct ClockTsc {
+   // fences keep rdtsc from being reordered with the measured code
+   static uint64_t Start() { _mm_lfence(); uint64_t t = __rdtsc(); _mm_lfence(); return t; }
+   static uint64_t Stop()  { return Start(); }
+};
+struct ClockTscp {
+   // rdtscp waits for the previous instructions, lfence holds the next ones
+   static uint64_t Start() { unsigned aux; uint64_t t = __rdtscp(&aux); _mm_lfence(); return t; }
+   static uint64_t Stop()  { return Start(); }
+};
+#endif
+//+------------------------------------------------------------------+
+//| Selected and calibrated clock                                    |
+//+------------------------------------------------------------------+
+class Clock {
+private:
+   EnClock           m_type;
+   double            m_frequency;            // ticks per second
+   double            m_ns_per_tick;          // nanoseconds per tick
+   uint64_t          m_overhead;             // minimal empty probe cost in nanoseconds
+   bool              m_subtract;             // subtract probe overhead from durations
+   bool              m_invariant;            // TSC is invariant (tsc/tscp only)
+
+public:
+                     Clock();
+
+   bool              Initialize(EnClock type, bool subtract);
+   void              Print() const;
+
+   EnClock           Type() const            { return m_type;      }
+   double            Frequency() const       { return m_frequency; }
+   uint64_t          Overhead() const        { return m_overhead;  }
+   bool              Subtract() const        { return m_subtract;  }
+   // convert ticks to nanoseconds
+   uint64_t          ToNs(uint64_t ticks) const { return uint64_t(ticks * m_ns_per_tick + 0.5); }
+   // convert measured duration in ticks to nanoseconds, optionally without probe overhead
+   uint64_t          DurationNs(uint64_t ticks) const {
+      uint64_t ns = ToNs(ticks);
+      if (m_subtract) return ns > m_overhead ? ns - m_overhead : 0;
+      return ns;
+   }
+
+   static EnClock    Default();
+   static bool       Parse(const std::string& name, EnClock& type);
+   static const char*Name(EnClock type);
+
+private:
+   template<class TClock>
+   uint64_t          MeasureOverhead() const;
+   bool              CalibrateTsc();
+};
+// globals
+extern Clock ExtClock;
+//+------------------------------------------------------------------+
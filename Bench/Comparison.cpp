@@ -0,0 +1,282 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "Comparison.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+//+------------------------------------------------------------------+
+//|                                                                  |
+//+------------------------------------------------------------------+
+Comparison::Comparison() : m_failed(false), m_rounds(0), m_elapsed(0) {}
+//+------------------------------------------------------------------+
+//| Cleanup                                                          |
+//+------------------------------------------------------------------+
+Comparison::~Comparison() {
+   // release tests instances
+   for (auto worker : m_workers) {
+      for (auto instance : worker->instances)
+         if (instance) instance->Release();
+      delete worker;
+   }
+   // release contexts and unload plugins
+   for (auto variant : m_variants) {
+      if (variant->context) variant->factory.DestroyContext(variant->context);
+      delete variant;
+   }
+}
+//+------------------------------------------------------------------+
+//| Load variants and prepare rounds order                           |
+//+------------------------------------------------------------------+
+bool Comparison::Initialize(const CompareCfg& cfg) {
+   m_cfg = cfg;
+   if (cfg.variants.size() < 2) {
+      std::cerr << "Compare \"" << cfg.name << "\" needs at least two variants" << std::endl;
+      return false;
+   }
+   // load libraries and create shared contexts
+   for (const auto& v : cfg.variants) {
+      Variant* variant = new Variant();
+      m_variants.push_back(variant);
+      variant->context = 0;
+      variant->batch   = cfg.batch;
+      if (!variant->factory.Load(v.library.c_str(), v.initializer.c_str())) {
+         std::cerr << "Compare \"" << cfg.name << "\" variant \"" << v.name << "\" load failed" << std::endl;
+         return false;
+      }
+      if (variant->batch > 1 && !variant->factory.SupportsBatch()) {
+         std::cerr << "Compare \"" << cfg.name << "\" variant \"" << v.name << "\" plugin API version " << variant->factory.Version()
+                   << " does not support batches, batch size " << variant->batch << " ignored" << std::endl;
+         variant->batch = 1;
+      }
+      if (!v.context.empty())
+         variant->context = variant->factory.CreateContext(v.context.c_str());
+   }
+   // the same random order of variants in every thread
+   std::mt19937_64 rng(cfg.seed);
+   std::vector<size_t> order(m_variants.size());
+   for (size_t r = 0; r < cfg.warmup_rounds + cfg.rounds; r++) {
+      for (size_t v = 0; v < order.size(); v++) order[v] = v;
+      std::shuffle(order.begin(), order.end(), rng);
+      m_order.push_back(order);
+   }
+   // threads placement
+   std::vector<int> cpus = ExtTopology.Layout(cfg.affinity, cfg.concurrency, cfg.affinity_cpus);
+   for (size_t i = 0; i < cfg.concurrency; i++) {
+      Worker* worker = new Worker();
+      worker->cpu    = cpus[i];
+      worker->rounds = 0;
+      m_workers.push_back(worker);
+   }
+   return true;
+}
+//+------------------------------------------------------------------+
+//| Run all threads through the rounds                               |
+//+------------------------------------------------------------------+
+void Comparison::Run() {
+   std::barrier sync_point(m_workers.size() + 1);
+   TThreads     threads;
+
+   for (auto worker : m_workers)
+      threads.emplace_back(&Comparison::RunWorker, this, std::ref(sync_point), worker);
+
+   // print comparison started
+   std::cout << "======================================================================================" << std::endl;
+   std::cout << "Compare \"" << m_cfg.name << "\" started: " << m_variants.size() << " variants, " << m_workers.size() << " threads, "
+             << m_cfg.rounds << " rounds";
+   if (m_cfg.warmup_rounds) std::cout << " (+" << m_cfg.warmup_rounds << " warmup)";
+   std::cout << " of " << m_cfg.samples << " samples in random order";
+   if (m_cfg.batch > 1) std::cout << ", batches of " << m_cfg.batch << " calls";
+   std::cout << std::endl;
+
+   // start all threads simultaneously, then leave rounds synchronization to them
+   sync_point.arrive_and_wait();
+   auto start_time = std::chrono::high_resolution_clock::now();
+   sync_point.arrive_and_drop();
+   for (auto& t : threads) t.join();
+   auto end_time = std::chrono::high_resolution_clock::now();
+   m_elapsed = double(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+
+   // rounds completed by all threads
+   m_rounds = SIZE_MAX;
+   for (auto worker : m_workers) m_rounds = std::min(m_rounds, worker->rounds);
+   m_rounds = m_rounds > m_cfg.warmup_rounds ? m_rounds - m_cfg.warmup_rounds : 0;
+   std::cout << "Compare \"" << m_cfg.name << "\" " << (ExtStop ? "interrupted" : "completed") << " in "
+             << Test::FormatDuration(m_elapsed) << ":" << std::endl << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Worker thread runs every variant in every round                  |
+//+------------------------------------------------------------------+
+void Comparison::RunWorker(std::barrier<>& sync, Worker* worker) {
+   size_t rounds  = m_order.size();
+   size_t samples = m_cfg.samples;
+   // pin the thread before it allocates anything
+   if (worker->cpu >= 0 && !Topology::Pin(worker->cpu)) {
+      std::lock_guard<std::mutex> lock(m_create_lock);
+      std::cerr << "Compare \"" << m_cfg.name << "\" failed to pin thread to CPU " << worker->cpu << std::endl;
+      worker->cpu = -1;
+   }
+   // instances and pre-faulted buffers of all variants are created by the thread itself
+   {
+      std::lock_guard<std::mutex> lock(m_create_lock);
+      for (size_t v = 0; v < m_variants.size(); v++) {
+         ITest* instance = m_variants[v]->factory.CreateTest(m_cfg.variants[v].initializer.c_str(), m_variants[v]->context);
+         if (!instance) {
+            std::cout << "Compare \"" << m_cfg.name << "\" failed to create variant \"" << m_cfg.variants[v].name << "\"" << std::endl;
+            m_failed = true;
+         }
+         worker->instances.push_back(instance);
+      }
+   }
+   try {
+      worker->durations.resize(m_variants.size());
+      for (auto& durations : worker->durations) durations.assign(rounds * samples, 0);
+   }
+   catch (const std::bad_alloc&) {
+      std::cerr << "Compare \"" << m_cfg.name << "\" failed to allocate samples buffers" << std::endl;
+      m_failed = true;
+   }
+   // synchronize start, all threads see the same failure flag after it
+   sync.arrive_and_wait();
+   if (m_failed) {
+      sync.arrive_and_drop();
+      return;
+   }
+
+   for (size_t r = 0; r < rounds; r++) {
+      for (size_t v : m_order[r]) {
+         // every variant slot starts simultaneously in all threads
+         if (ExtStop.load(std::memory_order_relaxed)) {
+            sync.arrive_and_drop();
+            return;
+         }
+         sync.arrive_and_wait();
+         // the clock is a template parameter to keep the samples loop free of dispatching
+         uint64_t* durations = worker->durations[v].data() + r * samples;
+         ITest*    instance  = worker->instances[v];
+         size_t    batch     = m_variants[v]->batch;
+         size_t    count     = 0;
+         switch (ExtClock.Type()) {
+            case CLOCK_TYPE_STEADY:        count = RunWithClock<ClockSteady>(instance, batch, durations, samples);       break;
+#ifdef _WIN32
+            case CLOCK_TYPE_QPC:           count = RunWithClock<ClockQpc>(instance, batch, durations, samples);          break;
+#else
+            case CLOCK_TYPE_MONOTONIC_RAW: count = RunWithClock<ClockMonotonicRaw>(instance, batch, durations, samples); break;
+#endif
+#ifdef BENCH_X86
+            case CLOCK_TYPE_TSC:           count = RunWithClock<ClockTsc>(instance, batch, durations, samples);          break;
+            case CLOCK_TYPE_TSCP:          count = RunWithClock<ClockTscp>(instance, batch, durations, samples);         break;
+#endif
+            default:                       break;
+         }
+         // incomplete round is not paired
+         if (count < samples) {
+            sync.arrive_and_drop();
+            return;
+         }
+      }
+      worker->rounds = r + 1;
+   }
+   sync.arrive_and_drop();
+}
+//+------------------------------------------------------------------+
+//| Select samples loop of the plugin                                |
+//+------------------------------------------------------------------+
+template<class TClock>
+size_t Comparison::RunWithClock(ITest* instance, size_t batch, uint64_t* durations, size_t samples) {
+   if (batch > 1) return RunSamples<TClock, true>(instance, batch, durations, samples);
+   return RunSamples<TClock, false>(instance, batch, durations, samples);
+}
+//+------------------------------------------------------------------+
+//| Closed samples loop of one round, returns completed samples      |
+//+------------------------------------------------------------------+
+template<class TClock, bool batched>
+size_t Comparison::RunSamples(ITest* instance, size_t batch, uint64_t* durations, size_t samples) {
+   size_t count;
+   for (count = 0; count < samples; count++) {
+      if (!instance->RunBefore()) break;
+      uint64_t start = TClock::Start();
+      if constexpr (batched) {
+         if (!instance->RunBatch(batch)) break;
+      }
+      else {
+         if (!instance->Run()) break;
+      }
+      uint64_t end = TClock::Stop();
+      durations[count] = end - start;
+      if (!instance->RunAfter()) break;
+      if (ExtStop.load(std::memory_order_relaxed)) return count + 1;
+   }
+   return count;
+}
+//+------------------------------------------------------------------+
+//| Pooled statistics of every variant and paired differences of     |
+//| round medians against the reference variant                      |
+//+------------------------------------------------------------------+
+void Comparison::ProcessStatistics() {
+   if (m_failed) return;
+   if (m_rounds == 0) {
+      std::cout << "  no complete rounds" << std::endl;
+      return;
+   }
+   size_t samples = m_cfg.samples;
+   size_t first   = m_cfg.warmup_rounds;
+   // per-call medians of every round, [variant][round]
+   std::vector<std::vector<double>> medians(m_variants.size(), std::vector<double>(m_rounds));
+   std::vector<uint64_t>            round(samples * m_workers.size()), pooled;
+
+   std::cout << "  Per call, all rounds of all threads:" << std::endl;
+   for (size_t v = 0; v < m_variants.size(); v++) {
+      double batch = double(m_variants[v]->batch);
+      pooled.clear();
+      for (size_t r = 0; r < m_rounds; r++) {
+         // samples of all threads in the round, nanoseconds
+         size_t n = 0;
+         for (auto worker : m_workers) {
+            const uint64_t* durations = worker->durations[v].data() + (first + r) * samples;
+            for (size_t i = 0; i < samples; i++) round[n++] = ExtClock.DurationNs(durations[i]);
+         }
+         std::nth_element(round.begin(), round.begin() + n / 2, round.begin() + n);
+         medians[v][r] = double(round[n / 2]) / batch;
+         pooled.insert(pooled.end(), round.begin(), round.begin() + n);
+      }
+      SampleStats stats;
+      Statistics::Calculate(pooled.data(), pooled.size(), stats);
+      std::cout << "  [" << std::setw(12) << std::left << m_cfg.variants[v].name.substr(0, 12) << std::right << "] med/p90/p99/avg = "
+                << std::setw(10) << Test::FormatDuration(stats.med  / batch) << " / "
+                << std::setw(10) << Test::FormatDuration(stats.p90  / batch) << " / "
+                << std::setw(10) << Test::FormatDuration(stats.p99  / batch) << " / "
+                << std::setw(10) << Test::FormatDuration(stats.mean / batch) << ", med CI "
+                << Test::FormatDuration(stats.med_low / batch) << " .. " << Test::FormatDuration(stats.med_high / batch)
+                << (v == 0 ? ", reference" : "") << std::endl;
+   }
+
+   // differences of round medians cancel the drift shared by the variants
+   std::cout << std::endl << "  Paired by " << m_rounds << " rounds against \"" << m_cfg.variants[0].name << "\", 95% CI:" << std::endl;
+   auto signed_duration = [](double ns) {
+      std::string res(1, ns < 0 ? '-' : '+');
+      return res.append(Test::FormatDuration(std::fabs(ns)));
+   };
+   for (size_t v = 1; v < m_variants.size(); v++) {
+      PairedStats paired;
+      Statistics::Paired(medians[0].data(), medians[v].data(), m_rounds, paired);
+      double      reference = 0;
+      for (double m : medians[0]) reference += m;
+      reference /= double(m_rounds);
+      const char* verdict = "no significant difference";
+      if (paired.diff_high < 0) verdict = "faster";
+      if (paired.diff_low  > 0) verdict = "slower";
+      std::cout << "  [" << std::setw(12) << std::left << m_cfg.variants[v].name.substr(0, 12) << std::right << "] difference "
+                << signed_duration(paired.diff) << " [" << signed_duration(paired.diff_low) << " .. " << signed_duration(paired.diff_high) << "]";
+      if (reference > 0)
+         std::cout << " (" << std::showpos << std::fixed << std::setprecision(2) << paired.diff / reference * 100.0 << "%" << std::noshowpos << ")";
+      std::cout << std::fixed << std::setprecision(3) << ", speedup " << paired.ratio << "x [" << paired.ratio_low << " .. " << paired.ratio_high << "]"
+                << std::defaultfloat << ", faster in " << paired.wins << "/" << paired.count << " rounds, " << verdict << std::endl;
+   }
+}
+//+------------------------------------------------------------------+
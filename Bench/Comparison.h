@@ -0,0 +1,79 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include "Test.h"
+
+//+------------------------------------------------------------------+
+//| Configuration of the interleaved comparison of variants          |
+//+------------------------------------------------------------------+
+struct CompareCfg {
+   struct Variant {
+      std::string name;                      // variant name, the first one is the reference
+      std::string library;                   // name of the DLL
+      std::string initializer;
+      std::string context;
+   };
+   typedef std::vector<Variant> Variants;
+
+   std::string    name;                      // comparison name
+   Variants       variants;
+   size_t         concurrency;               // number of concurrent threads
+   size_t         rounds;                    // measured rounds
+   size_t         warmup_rounds;             // discarded rounds
+   size_t         samples;                   // samples of every variant per round and thread
+   size_t         batch;                     // number of test function calls per sample
+   uint64_t       seed;                      // rounds order generator seed
+   EnAffinity     affinity;                  // threads placement
+   std::vector<int> affinity_cpus;           // CPUs of AFFINITY_LIST
+};
+//+------------------------------------------------------------------+
+//| Variants alternate in short rounds of random order on the same   |
+//| threads, so thermal, frequency and cache drift hits all of them  |
+//| alike and cancels out in the per-round differences               |
+//+------------------------------------------------------------------+
+class Comparison {
+   struct Variant {
+      TestFactory    factory;
+      UINT64         context;
+      size_t         batch;                  // calls per sample, 1 for plugins without batches
+   };
+   struct Worker {
+      int            cpu;                    // pinned CPU, -1 if not pinned
+      std::vector<ITest*> instances;         // instance of every variant
+      std::vector<std::vector<uint64_t>> durations; // [variant][round * samples + sample], clock ticks
+      size_t         rounds;                 // completed rounds including warmup
+   };
+   typedef std::vector<Variant*>            TVariants;
+   typedef std::vector<Worker*>             TWorkers;
+   typedef std::vector<std::thread>         TThreads;
+   typedef std::vector<std::vector<size_t>> TOrder;
+
+private:
+   CompareCfg        m_cfg;
+   TVariants         m_variants;
+   TWorkers          m_workers;
+   TOrder            m_order;                // variants order of every round
+   std::mutex        m_create_lock;          // worker threads create test instances one by one
+   std::atomic<bool> m_failed;               // some instance or buffer was not created
+   size_t            m_rounds;               // measured rounds completed by all threads
+   double            m_elapsed;              // wall time of the run in nanoseconds
+
+public:
+                     Comparison();
+                    ~Comparison();
+
+   bool              Initialize(const CompareCfg& cfg);
+   void              Run();
+   void              ProcessStatistics();
+
+private:
+   void              RunWorker(std::barrier<>& sync, Worker* worker);
+   template<class TClock>
+   size_t            RunWithClock(ITest* instance, size_t batch, uint64_t* durations, size_t samples);
+   template<class TClock, bool batched>
+   size_t            RunSamples(ITest* instance, size_t batch, uint64_t* durations, size_t samples);
+};
+//+------------------------------------------------------------------+
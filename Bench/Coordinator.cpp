@@ -0,0 +1,385 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "Coordinator.h"
+#include "Isolation.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+//+------------------------------------------------------------------+
+//| Blocking socket helpers                                          |
+//+------------------------------------------------------------------+
+static bool SendAll(int fd, const void* data, size_t size) {
+   const char* pos = static_cast<const char*>(data);
+   while (size > 0) {
+      ssize_t res = send(fd, pos, size, MSG_NOSIGNAL);
+      if (res < 0 && errno == EINTR) continue;
+      if (res <= 0) return false;
+      pos  += res;
+      size -= size_t(res);
+   }
+   return true;
+}
+static bool RecvAll(int fd, void* data, size_t size) {
+   char* pos = static_cast<char*>(data);
+   while (size > 0) {
+      ssize_t res = recv(fd, pos, size, 0);
+      if (res < 0 && errno == EINTR) continue;
+      if (res <= 0) return false;
+      pos  += res;
+      size -= size_t(res);
+   }
+   return true;
+}
+#endif
+//+------------------------------------------------------------------+
+//| Sockets and processes are POSIX only                             |
+//+------------------------------------------------------------------+
+bool Coordinator::Supported() {
+#ifdef _WIN32
+   return false;
+#else
+   return true;
+#endif
+}
+//+------------------------------------------------------------------+
+//| "host:port", port is optional                                    |
+//+------------------------------------------------------------------+
+bool Coordinator::SplitAddress(const std::string& address, std::string& host, int& port) {
+   size_t colon = address.rfind(':');
+   host = address.substr(0, colon);
+   port = 0;
+   if (colon != std::string::npos) {
+      char* end = NULL;
+      port = int(strtol(address.c_str() + colon + 1, &end, 10));
+      if (!end || *end != 0 || port < 0 || port > 65535) return false;
+   }
+   if (host.empty()) host = ADDRESS_DEFAULT;
+   return true;
+}
+//+------------------------------------------------------------------+
+//| Start all workers, release them together, collect results        |
+//+------------------------------------------------------------------+
+bool Coordinator::Run(const TestCfg& cfg, TestSummary* summary) {
+#ifdef _WIN32
+   std::cerr << "Test \"" << cfg.name << "\" worker processes are not supported on this platform" << std::endl;
+   return false;
+#else
+   std::string host;
+   int         port;
+   if (!SplitAddress(cfg.coordinator.empty() ? ADDRESS_DEFAULT : cfg.coordinator, host, port)) {
+      std::cerr << "Test \"" << cfg.name << "\" invalid coordinator address \"" << cfg.coordinator << "\"" << std::endl;
+      return false;
+   }
+   // loopback address listens on loopback only, otherwise on all interfaces
+   sockaddr_in addr{};
+   addr.sin_family = AF_INET;
+   addr.sin_port   = htons(uint16_t(port));
+   bool loopback = inet_pton(AF_INET, host.c_str(), &addr.sin_addr) == 1 && (ntohl(addr.sin_addr.s_addr) >> 24) == 127;
+   if (!loopback) addr.sin_addr.s_addr = htonl(INADDR_ANY);
+   int listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+   int reuse    = 1;
+   setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+   socklen_t len = sizeof(addr);
+   if (listener < 0 || bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, int(cfg.processes)) != 0 ||
+       getsockname(listener, (sockaddr*)&addr, &len) != 0) {
+      std::cerr << "Test \"" << cfg.name << "\" coordinator failed to listen on " << host << ":" << port << ": " << strerror(errno) << std::endl;
+      if (listener >= 0) close(listener);
+      return false;
+   }
+   std::string address = host + ":" + std::to_string(ntohs(addr.sin_port));
+
+   // launch workers
+   std::cout << "======================================================================================" << std::endl;
+   std::cout << "Test \"" << cfg.name << "\" started: " << cfg.processes << " processes of " << cfg.concurrency
+             << " threads, coordinator " << address << std::endl;
+   std::vector<int> children, workers(cfg.processes, -1);
+   for (size_t i = 0; i < cfg.processes; i++)
+      if (!Launch(cfg, address, i, children))
+         std::cerr << "Test \"" << cfg.name << "\" failed to launch worker " << i + 1 << std::endl;
+   // accept connections, every worker introduces itself with its index
+   for (size_t connected = 0; connected < cfg.processes;) {
+      pollfd pfd{ listener, POLLIN, 0 };
+      int    res = poll(&pfd, 1, CONNECT_TIMEOUT);
+      if (res < 0 && errno == EINTR) continue;
+      if (res <= 0) {
+         std::cerr << "Test \"" << cfg.name << "\" only " << connected << " of " << cfg.processes << " workers connected" << std::endl;
+         break;
+      }
+      int      fd    = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+      uint32_t index = 0;
+      if (fd < 0) continue;
+      if (!RecvAll(fd, &index, sizeof(index)) || index >= cfg.processes || workers[index] >= 0) {
+         close(fd);
+         continue;
+      }
+      int nodelay = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+      workers[index] = fd;
+      connected++;
+   }
+   close(listener);
+
+   // socket barrier: start, and the end of warmup of all workers
+   int  phases = (cfg.warmup || cfg.warmup_samples) ? 2 : 1;
+   auto start  = std::chrono::high_resolution_clock::now();
+   for (int phase = 0; phase < phases; phase++) {
+      for (auto& fd : workers) {
+         char message = 0;
+         if (fd >= 0 && (!RecvAll(fd, &message, 1) || message != MESSAGE_READY)) {
+            close(fd);
+            fd = -1;
+         }
+      }
+      // all ready workers are released at once
+      char go = MESSAGE_GO;
+      for (auto fd : workers)
+         if (fd >= 0) SendAll(fd, &go, 1);
+      start = std::chrono::high_resolution_clock::now();
+   }
+   // the run ends when the last worker completes, statistics and results transfer are not counted
+   for (auto& fd : workers) {
+      char message = 0;
+      if (fd >= 0 && (!RecvAll(fd, &message, 1) || message != MESSAGE_DONE)) {
+         close(fd);
+         fd = -1;
+      }
+   }
+   auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+   // results of every worker
+   std::vector<TestSummary> results(cfg.processes);
+   for (size_t i = 0; i < workers.size(); i++) {
+      uint64_t    size = 0;
+      std::string data;
+      if (workers[i] < 0) continue;
+      if (RecvAll(workers[i], &size, sizeof(size)) && size < (1ull << 32)) {
+         data.resize(size_t(size));
+         if (RecvAll(workers[i], data.data(), data.size()) && Isolation::Unpack(data, results[i]))
+            results[i].cfg = cfg;
+         else
+            results[i] = TestSummary{};
+      }
+      close(workers[i]);
+   }
+   for (int pid : children) {
+      int status;
+      while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+         ;
+   }
+   std::cout << "Test \"" << cfg.name << "\" " << (ExtStop ? "interrupted" : "completed") << " in "
+             << Test::FormatDuration(double(elapsed)) << ":" << std::endl << std::endl;
+
+   TestSummary merged{};
+   Merge(results, merged);
+   merged.cfg = cfg;
+   Print(cfg, results, merged);
+   if (summary) *summary = merged;
+   return merged.threads > 0;
+#endif
+}
+//+------------------------------------------------------------------+
+//| Start worker locally, or with the configured launch command      |
+//+------------------------------------------------------------------+
+bool Coordinator::Launch(const TestCfg& cfg, const std::string& address, size_t index, std::vector<int>& children) {
+#ifdef _WIN32
+   return false;
+#else
+   // path of this executable
+   std::string exe       = std::string(ExtProgramPath) + BENCH_PATH_SEP "bench";
+   std::string index_str = std::to_string(index);
+   std::string name      = EncodeName(cfg.name);
+   std::string command   = exe + " --worker " + address + " --test " + name + " --process " + index_str;
+   std::string launch    = cfg.launch;
+   if (!launch.empty()) {
+      for (size_t pos; (pos = launch.find("{command}")) != std::string::npos;) launch.replace(pos, 9, command);
+      for (size_t pos; (pos = launch.find("{index}")) != std::string::npos;)   launch.replace(pos, 7, index_str);
+   }
+
+   std::cout.flush();
+   std::cerr.flush();
+   pid_t pid = fork();
+   if (pid < 0) return false;
+   if (pid == 0) {
+      // local workers report through the coordinator only
+      if (launch.empty()) {
+         int null = open("/dev/null", O_WRONLY);
+         if (null >= 0) dup2(null, STDOUT_FILENO);
+         execl(exe.c_str(), exe.c_str(), "--worker", address.c_str(), "--test", name.c_str(), "--process", index_str.c_str(), (char*)NULL);
+      }
+      else
+         execl("/bin/sh", "sh", "-c", launch.c_str(), (char*)NULL);
+      _exit(127);
+   }
+   children.push_back(pid);
+   return true;
+#endif
+}
+//+------------------------------------------------------------------+
+//| Worker process: connect, wait for the start, send results        |
+//+------------------------------------------------------------------+
+int Coordinator::RunWorker(const TestCfg& cfg, const std::string& address, size_t index) {
+#ifdef _WIN32
+   return 1;
+#else
+   std::string host;
+   int         port;
+   addrinfo    hints{}, *info = NULL;
+   hints.ai_family   = AF_INET;
+   hints.ai_socktype = SOCK_STREAM;
+   if (!SplitAddress(address, host, port) || getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &info) != 0) {
+      std::cerr << "Worker: invalid coordinator address \"" << address << "\"" << std::endl;
+      return 1;
+   }
+   int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+   if (fd < 0 || connect(fd, info->ai_addr, info->ai_addrlen) != 0) {
+      std::cerr << "Worker: failed to connect to " << address << ": " << strerror(errno) << std::endl;
+      freeaddrinfo(info);
+      if (fd >= 0) close(fd);
+      return 1;
+   }
+   freeaddrinfo(info);
+   int      nodelay = 1;
+   uint32_t id      = uint32_t(index);
+   setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+   SendAll(fd, &id, sizeof(id));
+
+   Test test;
+   if (!test.Initialize(cfg)) {
+      char failed = MESSAGE_FAILED;
+      SendAll(fd, &failed, 1);
+      close(fd);
+      return 1;
+   }
+   // threads wait at the local barrier, the coordinator releases all processes
+   std::barrier sync_point(test.Threads() + 1);
+   bool         warmup = test.HasWarmup();
+   test.Launch(sync_point, warmup);
+   for (size_t phase = 1; phase <= (warmup ? 2u : 1u); phase++) {
+      while (test.Arrived() < test.Threads() * phase)
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      char message = MESSAGE_READY;
+      if (!SendAll(fd, &message, 1) || !RecvAll(fd, &message, 1) || message != MESSAGE_GO)
+         std::cerr << "Worker: coordinator is lost, starting alone" << std::endl;
+      sync_point.arrive_and_wait();
+   }
+   test.Started();
+   bool completed = test.Join();
+   char done      = MESSAGE_DONE;
+   SendAll(fd, &done, 1);
+   // a worker without running threads sends empty results
+   if (completed) test.ProcessStatistics();
+
+   // results to the coordinator
+   std::string data = Isolation::Pack(test.Summary());
+   uint64_t    size = data.size();
+   bool        sent = SendAll(fd, &size, sizeof(size)) && SendAll(fd, data.data(), data.size());
+   close(fd);
+   return sent ? 0 : 1;
+#endif
+}
+//+------------------------------------------------------------------+
+//| Characters other than letters, digits and "_.@-" become "%XX",   |
+//| so names with spaces or globs survive the launch command and ssh |
+//+------------------------------------------------------------------+
+std::string Coordinator::EncodeName(const std::string& name) {
+   static const char hex[] = "0123456789ABCDEF";
+   std::string res;
+   for (unsigned char c : name) {
+      if (isalnum(c) || c == '_' || c == '.' || c == '@' || c == '-') res += char(c);
+      else {
+         res += '%';
+         res += hex[c >> 4];
+         res += hex[c & 15];
+      }
+   }
+   return res;
+}
+std::string Coordinator::DecodeName(const std::string& value) {
+   std::string res;
+   for (size_t i = 0; i < value.size(); i++) {
+      if (value[i] == '%' && i + 2 < value.size() && isxdigit((unsigned char)value[i + 1]) && isxdigit((unsigned char)value[i + 2])) {
+         res += char(std::stoi(value.substr(i + 1, 2), NULL, 16));
+         i   += 2;
+      }
+      else
+         res += value[i];
+   }
+   return res;
+}
+//+------------------------------------------------------------------+
+//| Merge histograms, counters and totals of workers                 |
+//+------------------------------------------------------------------+
+void Coordinator::Merge(const std::vector<TestSummary>& results, TestSummary& merged) {
+   for (const auto& r : results) {
+      if (!r.threads) continue;
+      if (!merged.threads) {
+         merged.batch    = r.batch;
+         merged.revision = r.revision;
+      }
+      merged.threads    += r.threads;
+      merged.calls      += r.calls;
+      merged.elapsed     = std::max(merged.elapsed, r.elapsed);
+      merged.throughput += r.throughput;   // workers run at the same time
+      merged.items      += r.items;
+      merged.bytes      += r.bytes;
+      merged.thread_stats.insert(merged.thread_stats.end(), r.thread_stats.begin(), r.thread_stats.end());
+      merged.histogram.Merge(r.histogram);
+      for (int c = 0; c < COUNTER_TOTAL; c++) merged.counters[c] += r.counters[c];
+      merged.counters_opened |= r.counters_opened;
+   }
+   if (merged.histogram.Count()) Statistics::Calculate(merged.histogram, merged.stats);
+}
+//+------------------------------------------------------------------+
+//| Per-process breakdown and merged results                         |
+//+------------------------------------------------------------------+
+void Coordinator::Print(const TestCfg& cfg, const std::vector<TestSummary>& results, const TestSummary& merged) {
+   auto print = [](const std::string& id, const TestSummary& r) {
+      std::cout << "  [" << std::setw(2) << std::right << id << "] ";
+      if (!r.threads || !r.stats.count) {
+         std::cout << "no results" << std::endl;
+         return;
+      }
+      double batch = double(r.batch);
+      std::cout << std::setw(3) << r.threads << " threads, med/p90/p99/max = "
+                << std::setw(10) << Test::FormatDuration(r.stats.med / batch) << " / "
+                << std::setw(10) << Test::FormatDuration(r.stats.p90 / batch) << " / "
+                << std::setw(10) << Test::FormatDuration(r.stats.p99 / batch) << " / "
+                << std::setw(10) << Test::FormatDuration(r.stats.max / batch) << ", "
+                << std::fixed << std::setprecision(0) << r.throughput << " calls/s" << std::defaultfloat << std::endl;
+   };
+   auto process = [](size_t i) {
+      std::string id(1, 'p');
+      return id += std::to_string(i + 1);
+   };
+   std::cout << "  Per process, per call:" << std::endl;
+   for (size_t i = 0; i < results.size(); i++) print(process(i), results[i]);
+   print("**", merged);
+   // counters of all processes
+   if (cfg.counters) {
+      std::cout << std::endl;
+      for (size_t i = 0; i < results.size(); i++)
+         Test::PrintCounters(process(i), results[i].counters, results[i].counters_opened, results[i].calls);
+      Test::PrintCounters("**", merged.counters, merged.counters_opened, merged.calls);
+   }
+   std::cout << "======================================================================================" << std::endl;
+}
+//+------------------------------------------------------------------+
@@ -0,0 +1,44 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include "Test.h"
+
+//+------------------------------------------------------------------+
+//| Test spread over several worker processes. The coordinator       |
+//| launches workers (this executable with "--worker"), they connect |
+//| back over TCP, wait at a socket barrier until all of them are    |
+//| ready, run the test and send their results, which are merged     |
+//| into one report (POSIX only)                                     |
+//+------------------------------------------------------------------+
+class Coordinator {
+public:
+   static constexpr const char* ADDRESS_DEFAULT = "127.0.0.1";
+   static constexpr int         CONNECT_TIMEOUT = 30'000;   // milliseconds to wait for workers
+
+   // barrier and results messages
+   enum EnMessage : char {
+      MESSAGE_READY  = 'R',                  // worker threads are waiting at the barrier
+      MESSAGE_FAILED = 'F',                  // worker failed to initialize the test
+      MESSAGE_GO     = 'G',                  // release the barrier
+      MESSAGE_DONE   = 'D',                  // worker threads completed, results follow
+   };
+
+   static bool       Supported();
+   // coordinator side, summary gets merged results of all workers
+   static bool       Run(const TestCfg& cfg, TestSummary* summary);
+   // worker side, returns process exit code
+   static int        RunWorker(const TestCfg& cfg, const std::string& address, size_t index);
+   // test name in the worker command line, "%XX" escapes are safe at any shell level
+   static std::string EncodeName(const std::string& name);
+   static std::string DecodeName(const std::string& value);
+
+private:
+   static bool       Launch(const TestCfg& cfg, const std::string& address, size_t index, std::vector<int>& children);
+   static void       Merge(const std::vector<TestSummary>& results, TestSummary& merged);
+   static void       Print(const TestCfg& cfg, const std::vector<TestSummary>& results, const TestSummary& merged);
+   static bool       SplitAddress(const std::string& address, std::string& host, int& port);
+};
+//+------------------------------------------------------------------+
@@ -0,0 +1,165 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "Counters.h"
+#include <cstring>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+//+------------------------------------------------------------------+
+//| Initialization                                                   |
+//+------------------------------------------------------------------+
+PerfCounters::PerfCounters() : m_hw_leader(-1), m_sw_leader(-1), m_mask(0) {
+   for (int i = 0; i < COUNTER_TOTAL; i++) {
+      m_fds[i]    = -1;
+      m_values[i] = 0;
+   }
+}
+//+------------------------------------------------------------------+
+//| Cleanup                                                          |
+//+------------------------------------------------------------------+
+PerfCounters::~PerfCounters() {
+   Close();
+}
+#ifdef __linux__
+//+------------------------------------------------------------------+
+//| Open counters of the calling thread, disabled                    |
+//+------------------------------------------------------------------+
+bool PerfCounters::Open(uint32_t mask, std::string& error) {
+   static const struct { uint32_t type; uint64_t config; } events[COUNTER_TOTAL] = {
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES       },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS     },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES     },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES    },
+      { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+   };
+
+   Close();
+   m_mask = mask;
+   for (int i = 0; i < COUNTER_TOTAL; i++) {
+      if (!(mask & Mask(EnCounter(i)))) continue;
+
+      // the first event of its type becomes the group leader
+      int& leader = events[i].type == PERF_TYPE_HARDWARE ? m_hw_leader : m_sw_leader;
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size          = sizeof(attr);
+      attr.type          = events[i].type;
+      attr.config        = events[i].config;
+      attr.disabled      = leader < 0;  // members follow the leader
+      attr.exclude_kernel= 1;
+      attr.exclude_hv    = 1;
+      attr.read_format   = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      // context switches are counted by kernel
+      if (events[i].type == PERF_TYPE_SOFTWARE) attr.exclude_kernel = 0;
+
+      int fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+      if (fd < 0) {
+         if (!error.empty()) error += ", ";
+         error += std::string(Name(EnCounter(i))) + ": " + strerror(errno);
+         continue;
+      }
+      m_fds[i] = fd;
+      if (leader < 0) leader = fd;
+   }
+   return error.empty();
+}
+//+------------------------------------------------------------------+
+//| Close counters                                                   |
+//+------------------------------------------------------------------+
+void PerfCounters::Close() {
+   for (int i = 0; i < COUNTER_TOTAL; i++) {
+      if (m_fds[i] >= 0) close(m_fds[i]);
+      m_fds[i] = -1;
+   }
+   m_hw_leader = m_sw_leader = -1;
+}
+//+------------------------------------------------------------------+
+//| Start counting                                                   |
+//+------------------------------------------------------------------+
+void PerfCounters::Enable() {
+   if (m_hw_leader >= 0) ioctl(m_hw_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+   if (m_sw_leader >= 0) ioctl(m_sw_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+//+------------------------------------------------------------------+
+//| Stop counting                                                    |
+//+------------------------------------------------------------------+
+void PerfCounters::Disable() {
+   if (m_hw_leader >= 0) ioctl(m_hw_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+   if (m_sw_leader >= 0) ioctl(m_sw_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+//+------------------------------------------------------------------+
+//| Read counted values                                              |
+//+------------------------------------------------------------------+
+void PerfCounters::Read() {
+   ReadGroup(m_hw_leader);
+   ReadGroup(m_sw_leader);
+}
+//+------------------------------------------------------------------+
+//| Read group values in the order they were opened                  |
+//+------------------------------------------------------------------+
+void PerfCounters::ReadGroup(int leader) {
+   // nr, time_enabled, time_running, values[nr]
+   uint64_t data[3 + COUNTER_TOTAL];
+   if (leader < 0) return;
+   if (read(leader, data, sizeof(data)) < ssize_t(3 * sizeof(uint64_t))) return;
+
+   // scale values if counters were multiplexed
+   double scale = data[2] ? double(data[1]) / double(data[2]) : 1.0;
+   size_t index = 3;
+   for (int i = 0; i < COUNTER_TOTAL && index < 3 + data[0]; i++) {
+      if (m_fds[i] < 0) continue;
+      // members of the other group are skipped
+      bool hardware = i != COUNTER_CONTEXT_SWITCHES;
+      if (hardware != (leader == m_hw_leader)) continue;
+      m_values[i] = uint64_t(data[index++] * scale);
+   }
+}
+#else
+//+------------------------------------------------------------------+
+//| Performance counters are not supported on this platform          |
+//+------------------------------------------------------------------+
+bool PerfCounters::Open(uint32_t mask, std::string& error) {
+   m_mask = mask;
+   error  = "performance counters are supported on Linux only";
+   return false;
+}
+void PerfCounters::Close()   {}
+void PerfCounters::Enable()  {}
+void PerfCounters::Disable() {}
+void PerfCounters::Read()    {}
+void PerfCounters::ReadGroup(int) {}
+#endif
+//+------------------------------------------------------------------+
+//| Parse counter name                                               |
+//+------------------------------------------------------------------+
+bool PerfCounters::Parse(const std::string& name, EnCounter& counter) {
+   for (int i = 0; i < COUNTER_TOTAL; i++)
+      if (name == Name(EnCounter(i))) {
+         counter = EnCounter(i);
+         return true;
+      }
+   return false;
+}
+//+------------------------------------------------------------------+
+//| Counter name                                                     |
+//+------------------------------------------------------------------+
+const char* PerfCounters::Name(EnCounter counter) {
+   switch (counter) {
+      case COUNTER_CYCLES:           return "cycles";
+      case COUNTER_INSTRUCTIONS:     return "instructions";
+      case COUNTER_LLC_MISSES:       return "llc-misses";
+      case COUNTER_BRANCH_MISSES:    return "branch-misses";
+      case COUNTER_CONTEXT_SWITCHES: return "context-switches";
+      default:                       break;
+   }
+   return "unknown";
+}
+//+------------------------------------------------------------------+
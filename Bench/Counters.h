@@ -0,0 +1,63 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include <string>
+#include <cstdint>
+
+//+------------------------------------------------------------------+
+//| Hardware and software performance counters                       |
+//+------------------------------------------------------------------+
+enum EnCounter {
+   COUNTER_CYCLES,
+   COUNTER_INSTRUCTIONS,
+   COUNTER_LLC_MISSES,
+   COUNTER_BRANCH_MISSES,
+   COUNTER_CONTEXT_SWITCHES,
+   COUNTER_TOTAL
+};
+//+------------------------------------------------------------------+
+//| Counted region                                                   |
+//+------------------------------------------------------------------+
+enum EnCounterScope {
+   COUNTERS_SCOPE_LOOP,                      // the whole samples loop
+   COUNTERS_SCOPE_SAMPLE,                    // only the measured region of every sample
+};
+//+------------------------------------------------------------------+
+//| Counters of the calling thread (perf_event_open, Linux only).    |
+//| Hardware counters are opened as one group to be scheduled        |
+//| together, context switches are a software event in own group.    |
+//+------------------------------------------------------------------+
+class PerfCounters {
+private:
+   int               m_fds[COUNTER_TOTAL];   // event descriptors
+   int               m_hw_leader;            // hardware group leader
+   int               m_sw_leader;            // software group leader
+   uint32_t          m_mask;                 // requested counters
+   uint64_t          m_values[COUNTER_TOTAL];// read values, scaled if multiplexed
+
+public:
+                     PerfCounters();
+                    ~PerfCounters();
+                     PerfCounters(const PerfCounters&) = delete;
+   PerfCounters&     operator=(const PerfCounters&) = delete;
+
+   bool              Open(uint32_t mask, std::string& error);
+   void              Close();
+   void              Enable();
+   void              Disable();
+   void              Read();
+
+   bool              IsOpened(EnCounter counter) const { return m_fds[counter] >= 0; }
+   uint64_t          Value(EnCounter counter) const    { return m_values[counter]; }
+
+   static uint32_t   Mask(EnCounter counter)           { return 1u << counter; }
+   static bool       Parse(const std::string& name, EnCounter& counter);
+   static const char* Name(EnCounter counter);
+
+private:
+   void              ReadGroup(int leader);
+};
+//+------------------------------------------------------------------+
@@ -0,0 +1,141 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "Histogram.h"
+#include <cmath>
+#include <algorithm>
+
+//+------------------------------------------------------------------+
+//| Initialization                                                   |
+//+------------------------------------------------------------------+
+Histogram::Histogram() : m_digits(0), m_sub_bits(0), m_sub_mask(0),
+                         m_total(0), m_sum(0), m_min(UINT64_MAX), m_max(0) {
+}
+//+------------------------------------------------------------------+
+//| Allocate counters for the precision, 1..4 significant digits     |
+//| (3 digits take 250 KB, 4 digits take 3.5 MB)                     |
+//+------------------------------------------------------------------+
+bool Histogram::Initialize(int digits) {
+   if (digits < 1) digits = 1;
+   if (digits > 4) digits = 4;
+   m_digits  = digits;
+   // values below 2*10^digits are counted with unit resolution
+   m_sub_bits = int(std::ceil(std::log2(2.0 * std::pow(10.0, digits))));
+   m_sub_mask = (1ull << m_sub_bits) - 1;
+   // allocate all counters at once, memory doesn't depend on the number of samples
+   m_counts.assign(Index(HIGHEST_VALUE) + 1, 0);
+   Reset();
+   return true;
+}
+//+------------------------------------------------------------------+
+//| Clear all counters                                               |
+//+------------------------------------------------------------------+
+void Histogram::Reset() {
+   std::fill(m_counts.begin(), m_counts.end(), 0);
+   m_total = 0;
+   m_sum   = 0;
+   m_min   = UINT64_MAX;
+   m_max   = 0;
+}
+//+------------------------------------------------------------------+
+//| Add counters of the histogram with the same precision            |
+//+------------------------------------------------------------------+
+bool Histogram::Merge(const Histogram& other) {
+   // empty histogram takes the precision of the first merged one
+   if (m_counts.empty()) Initialize(other.m_digits);
+   if (other.m_digits != m_digits) return false;
+
+   for (size_t i = 0; i < m_counts.size(); i++)
+      m_counts[i] += other.m_counts[i];
+   m_total += other.m_total;
+   m_sum   += other.m_sum;
+   if (other.m_min < m_min) m_min = other.m_min;
+   if (other.m_max > m_max) m_max = other.m_max;
+   return true;
+}
+//+------------------------------------------------------------------+
+//| Compact copy of the counters                                     |
+//+------------------------------------------------------------------+
+void Histogram::Export(std::vector<uint64_t>& data) const {
+   data.clear();
+   if (m_counts.empty()) return;
+   data.insert(data.end(), { uint64_t(m_digits), m_total, m_sum, m_min, m_max });
+   for (size_t i = 0; i < m_counts.size(); i++)
+      if (m_counts[i]) data.insert(data.end(), { uint64_t(i), m_counts[i] });
+}
+//+------------------------------------------------------------------+
+//| Restore exported counters                                        |
+//+------------------------------------------------------------------+
+bool Histogram::Import(const std::vector<uint64_t>& data) {
+   if (data.empty()) {
+      *this = Histogram();
+      return true;
+   }
+   if (data.size() < 5 || (data.size() - 5) % 2 != 0) return false;
+   Initialize(int(data[0]));
+   if (uint64_t(m_digits) != data[0]) return false;
+   for (size_t i = 5; i < data.size(); i += 2) {
+      if (data[i] >= m_counts.size()) return false;
+      m_counts[data[i]] = data[i + 1];
+   }
+   m_total = data[1];
+   m_sum   = data[2];
+   m_min   = data[3];
+   m_max   = data[4];
+   return true;
+}
+//+------------------------------------------------------------------+
+//| Value at percentile, middle of the sub-bucket                    |
+//+------------------------------------------------------------------+
+uint64_t Histogram::Percentile(double percentile) const {
+   if (m_total == 0)         return 0;
+   if (percentile <= 0.0)    return m_min;
+   if (percentile >= 100.0)  return m_max;
+
+   // rank of the value
+   return ValueAtRank(uint64_t(std::ceil(percentile / 100.0 * m_total)));
+}
+//+------------------------------------------------------------------+
+//| Value at rank, middle of the sub-bucket                          |
+//+------------------------------------------------------------------+
+uint64_t Histogram::ValueAtRank(uint64_t rank) const {
+   if (rank < 1) rank = 1;
+   // find sub-bucket containing it
+   uint64_t count = 0;
+   for (size_t i = 0; i < m_counts.size(); i++) {
+      count += m_counts[i];
+      if (count >= rank) return Value(i);
+   }
+   return m_max;
+}
+//+------------------------------------------------------------------+
+//| Lowest value counted by the sub-bucket                           |
+//+------------------------------------------------------------------+
+uint64_t Histogram::ValueLowest(size_t index) const {
+   uint64_t half = (m_sub_mask + 1) >> 1;
+   // first bucket has unit resolution
+   if (index < half) return index;
+   int      bucket = int(index >> (m_sub_bits - 1)) - 1;
+   uint64_t sub    = (index & (half - 1)) + half;
+   return sub << bucket;
+}
+//+------------------------------------------------------------------+
+//| Range of values counted by the sub-bucket                        |
+//+------------------------------------------------------------------+
+uint64_t Histogram::ValueWidth(size_t index) const {
+   uint64_t half = (m_sub_mask + 1) >> 1;
+   if (index < half) return 1;
+   return 1ull << (int(index >> (m_sub_bits - 1)) - 1);
+}
+//+------------------------------------------------------------------+
+//| Value representing the sub-bucket, limited by exact min/max      |
+//+------------------------------------------------------------------+
+uint64_t Histogram::Value(size_t index) const {
+   uint64_t value = ValueLowest(index) + ValueWidth(index) / 2;
+   if (value < m_min) value = m_min;
+   if (value > m_max) value = m_max;
+   return value;
+}
+//+------------------------------------------------------------------+
@@ -0,0 +1,83 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+
+//+------------------------------------------------------------------+
+//| Log-bucketed latency histogram (HdrHistogram layout)             |
+//| Values are split into power of two buckets, each bucket is split |
+//| into linear sub-buckets, so the relative error stays below the   |
+//| configured number of significant digits for any value.           |
+//+------------------------------------------------------------------+
+class Histogram {
+public:
+   static constexpr int      DIGITS_DEFAULT = 3;
+   static constexpr uint64_t HIGHEST_VALUE  = 1ull << 40;   // ~18 minutes in nanoseconds, larger values are clamped
+
+private:
+   typedef std::vector<uint64_t> TCounts;
+
+   int               m_digits;               // significant decimal digits
+   int               m_sub_bits;             // log2 of sub-buckets count
+   uint64_t          m_sub_mask;             // sub-buckets count - 1
+   TCounts           m_counts;               // counters
+   uint64_t          m_total;                // number of recorded values
+   uint64_t          m_sum;                  // sum of recorded values
+   uint64_t          m_min;                  // exact min
+   uint64_t          m_max;                  // exact max
+
+public:
+                     Histogram();
+
+   bool              Initialize(int digits);
+   void              Reset();
+   bool              Merge(const Histogram& other);
+   // compact copy for transfer between processes: digits, total, sum, min, max,
+   // then index and count of every non-empty counter
+   void              Export(std::vector<uint64_t>& data) const;
+   bool              Import(const std::vector<uint64_t>& data);
+
+   // record single value
+   void              Record(uint64_t value) {
+      m_counts[Index(value < HIGHEST_VALUE ? value : HIGHEST_VALUE)]++;
+      m_total++;
+      m_sum += value;
+      if (value < m_min) m_min = value;
+      if (value > m_max) m_max = value;
+   }
+
+   int               Digits() const          { return m_digits; }
+   uint64_t          Count() const           { return m_total;  }
+   uint64_t          Sum() const             { return m_sum;    }
+   uint64_t          Min() const             { return m_total ? m_min : 0; }
+   uint64_t          Max() const             { return m_max;    }
+   uint64_t          Mean() const            { return m_total ? m_sum / m_total : 0; }
+   size_t            MemorySize() const      { return m_counts.size() * sizeof(uint64_t); }
+   // value at percentile [0..100]
+   uint64_t          Percentile(double percentile) const;
+   // value at rank [1..Count()]
+   uint64_t          ValueAtRank(uint64_t rank) const;
+   // call func(value, count) for every non-empty sub-bucket, value is the middle of the sub-bucket
+   template<class TFunc>
+   void              ForEach(TFunc func) const {
+      for (size_t i = 0; i < m_counts.size(); i++)
+         if (m_counts[i]) func(Value(i), m_counts[i]);
+   }
+
+private:
+   // counters index of the value
+   size_t            Index(uint64_t value) const {
+      int bucket = 64 - std::countl_zero(value | m_sub_mask) - m_sub_bits;
+      return (size_t(bucket + 1) << (m_sub_bits - 1)) + (value >> bucket) - ((m_sub_mask + 1) >> 1);
+   }
+   uint64_t          ValueLowest(size_t index) const;
+   uint64_t          ValueWidth(size_t index) const;
+   uint64_t          Value(size_t index) const;
+};
+//+------------------------------------------------------------------+
@@ -0,0 +1,225 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "Isolation.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#endif
+
+//+------------------------------------------------------------------+
+//| Binary writer of trivially copyable values                       |
+//+------------------------------------------------------------------+
+class Packer {
+private:
+   std::string       m_data;
+
+public:
+   template<class T>
+   void              Put(const T& value) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      m_data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+   }
+   void              Put(const std::string& value) {
+      Put(uint64_t(value.size()));
+      m_data.append(value);
+   }
+   template<class T>
+   void              Put(const std::vector<T>& values) {
+      Put(uint64_t(values.size()));
+      for (const auto& value : values) Put(value);
+   }
+   const std::string& Data() const { return m_data; }
+};
+//+------------------------------------------------------------------+
+//| Binary reader, fails on truncated data                           |
+//+------------------------------------------------------------------+
+class Unpacker {
+private:
+   const char*       m_pos;
+   const char*       m_end;
+
+public:
+                     Unpacker(const std::string& data) : m_pos(data.data()), m_end(data.data() + data.size()) {}
+
+   template<class T>
+   bool              Get(T& value) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      if (size_t(m_end - m_pos) < sizeof(value)) return false;
+      memcpy(&value, m_pos, sizeof(value));
+      m_pos += sizeof(value);
+      return true;
+   }
+   bool              Get(std::string& value) {
+      uint64_t size;
+      if (!Get(size) || size_t(m_end - m_pos) < size) return false;
+      value.assign(m_pos, size_t(size));
+      m_pos += size;
+      return true;
+   }
+   template<class T>
+   bool              Get(std::vector<T>& values) {
+      uint64_t size;
+      if (!Get(size) || size > size_t(m_end - m_pos)) return false;
+      values.resize(size_t(size));
+      for (auto& value : values)
+         if (!Get(value)) return false;
+      return true;
+   }
+   bool              End() const { return m_pos == m_end; }
+};
+//+------------------------------------------------------------------+
+//| Processes are forked on POSIX systems only                       |
+//+------------------------------------------------------------------+
+bool Isolation::Supported() {
+#ifdef _WIN32
+   return false;
+#else
+   return true;
+#endif
+}
+//+------------------------------------------------------------------+
+//| Fork, run and collect results and resource usage of the child    |
+//+------------------------------------------------------------------+
+bool Isolation::Run(const std::string& name, const TRunFunc& func, TestSummary& summary) {
+#ifdef _WIN32
+   return false;
+#else
+   int fds[2];
+   if (pipe(fds) != 0) {
+      std::cerr << "Test \"" << name << "\" failed to create pipe: " << strerror(errno) << std::endl;
+      return false;
+   }
+   // buffered output must not be written twice
+   std::cout.flush();
+   std::cerr.flush();
+   fflush(NULL);
+   pid_t pid = fork();
+   if (pid < 0) {
+      std::cerr << "Test \"" << name << "\" failed to start process: " << strerror(errno) << std::endl;
+      close(fds[0]);
+      close(fds[1]);
+      return false;
+   }
+   // child runs the test and leaves without exit handlers of the parent
+   if (pid == 0) {
+      close(fds[0]);
+      TestSummary result{};
+      func(result);
+      std::string data = Pack(result);
+      for (size_t sent = 0; sent < data.size();) {
+         ssize_t res = write(fds[1], data.data() + sent, data.size() - sent);
+         if (res < 0 && errno == EINTR) continue;
+         if (res <= 0) break;
+         sent += size_t(res);
+      }
+      close(fds[1]);
+      std::cout.flush();
+      std::cerr.flush();
+      _exit(0);
+   }
+
+   // read results until the child closes the pipe
+   close(fds[1]);
+   std::string data;
+   char        buffer[65536];
+   for (;;) {
+      ssize_t res = read(fds[0], buffer, sizeof(buffer));
+      if (res < 0 && errno == EINTR) continue;
+      if (res <= 0) break;
+      data.append(buffer, size_t(res));
+   }
+   close(fds[0]);
+   int     status = 0;
+   rusage  usage{};
+   while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR)
+      ;
+
+   // resources of the child only
+   ProcessUsage process{};
+   process.valid                = true;
+   process.max_rss              = uint64_t(usage.ru_maxrss) * 1024;    // kilobytes on Linux
+   process.faults_minor         = uint64_t(usage.ru_minflt);
+   process.faults_major         = uint64_t(usage.ru_majflt);
+   process.switches_voluntary   = uint64_t(usage.ru_nvcsw);
+   process.switches_involuntary = uint64_t(usage.ru_nivcsw);
+   process.user                 = usage.ru_utime.tv_sec * 1e9 + usage.ru_utime.tv_usec * 1e3;
+   process.system               = usage.ru_stime.tv_sec * 1e9 + usage.ru_stime.tv_usec * 1e3;
+   PrintUsage(name, process);
+   if (WIFSIGNALED(status)) {
+      std::cerr << "Test \"" << name << "\" process terminated by signal " << WTERMSIG(status)
+                << " (" << strsignal(WTERMSIG(status)) << ")" << std::endl;
+      return false;
+   }
+   if (!Unpack(data, summary)) {
+      std::cerr << "Test \"" << name << "\" process returned no results, exit code " << WEXITSTATUS(status) << std::endl;
+      return false;
+   }
+   summary.usage = process;
+   return true;
+#endif
+}
+//+------------------------------------------------------------------+
+//| Results without the configuration, the parent has it             |
+//+------------------------------------------------------------------+
+std::string Isolation::Pack(const TestSummary& summary) {
+   Packer                packer;
+   std::vector<uint64_t> histogram;
+   summary.histogram.Export(histogram);
+   packer.Put(FORMAT_MAGIC);
+   packer.Put(uint64_t(summary.threads));
+   packer.Put(uint64_t(summary.batch));
+   packer.Put(summary.calls);
+   packer.Put(summary.elapsed);
+   packer.Put(summary.throughput);
+   packer.Put(summary.stats);
+   packer.Put(summary.thread_stats);
+   packer.Put(histogram);
+   packer.Put(summary.revision);
+   packer.Put(summary.items);
+   packer.Put(summary.bytes);
+   packer.Put(summary.counters);
+   packer.Put(summary.counters_opened);
+   return packer.Data();
+}
+//+------------------------------------------------------------------+
+//| Restore results sent by the child                                |
+//+------------------------------------------------------------------+
+bool Isolation::Unpack(const std::string& data, TestSummary& summary) {
+   Unpacker              unpacker(data);
+   uint32_t              magic = 0;
+   uint64_t              threads = 0, batch = 0;
+   std::vector<uint64_t> histogram;
+   if (!unpacker.Get(magic) || magic != FORMAT_MAGIC) return false;
+   bool res = unpacker.Get(threads) && unpacker.Get(batch) && unpacker.Get(summary.calls) &&
+              unpacker.Get(summary.elapsed) && unpacker.Get(summary.throughput) &&
+              unpacker.Get(summary.stats) && unpacker.Get(summary.thread_stats) &&
+              unpacker.Get(histogram) && unpacker.Get(summary.revision) &&
+              unpacker.Get(summary.items) && unpacker.Get(summary.bytes) &&
+              unpacker.Get(summary.counters) && unpacker.Get(summary.counters_opened) && unpacker.End();
+   if (!res || !summary.histogram.Import(histogram)) return false;
+   summary.threads = size_t(threads);
+   summary.batch   = size_t(batch);
+   return true;
+}
+//+------------------------------------------------------------------+
+//| Print resource usage of the test process                         |
+//+------------------------------------------------------------------+
+void Isolation::PrintUsage(const std::string& name, const ProcessUsage& usage) {
+   std::cout << "Test \"" << name << "\" process: max RSS " << std::fixed << std::setprecision(1)
+             << double(usage.max_rss) / (1024.0 * 1024.0) << " MB, page faults " << usage.faults_minor << " minor, "
+             << usage.faults_major << " major, context switches " << usage.switches_voluntary << " voluntary, "
+             << usage.switches_involuntary << " involuntary, CPU " << Test::FormatDuration(usage.user) << " user, "
+             << Test::FormatDuration(usage.system) << " system" << std::defaultfloat << std::endl;
+}
+//+------------------------------------------------------------------+
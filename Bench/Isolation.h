@@ -0,0 +1,31 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include "Test.h"
+#include <functional>
+
+//+------------------------------------------------------------------+
+//| Test in a child process: the plugin is loaded into a clean       |
+//| process, results are sent back over a pipe in a binary form and  |
+//| a crash of the plugin ends only the child (POSIX fork only)      |
+//+------------------------------------------------------------------+
+class Isolation {
+public:
+   typedef std::function<void(TestSummary&)> TRunFunc;
+
+   static constexpr uint32_t FORMAT_MAGIC = 0x53455242;   // "BRES"
+
+   static bool       Supported();
+   // runs func in a child process, false if no results were received
+   static bool       Run(const std::string& name, const TRunFunc& func, TestSummary& summary);
+   // binary form of the results without the configuration
+   static std::string Pack(const TestSummary& summary);
+   static bool       Unpack(const std::string& data, TestSummary& summary);
+
+private:
+   static void       PrintUsage(const std::string& name, const ProcessUsage& usage);
+};
+//+------------------------------------------------------------------+
@@ -0,0 +1,102 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "PageBuffer.h"
+#include "Platform.h"
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//+------------------------------------------------------------------+
+//| Huge page size used for rounding                                 |
+//+------------------------------------------------------------------+
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+#ifdef _WIN32
+//+------------------------------------------------------------------+
+//| Allocate committed pages, large pages need SeLockMemoryPrivilege |
+//+------------------------------------------------------------------+
+void* PageMemory::Allocate(size_t bytes, unsigned flags, unsigned& applied, std::string& warnings) {
+   void* ptr = NULL;
+   applied   = 0;
+   if (bytes == 0) bytes = 1;
+   if (flags & PAGES_HUGE) {
+      size_t large = GetLargePageMinimum();
+      if (large) {
+         ptr = VirtualAlloc(NULL, (bytes + large - 1) / large * large, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+         // large pages are always locked
+         if (ptr) applied |= PAGES_HUGE | PAGES_LOCKED;
+      }
+      if (!ptr) warnings += "large pages are not available; ";
+   }
+   if (!ptr) ptr = VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+   if (!ptr) return NULL;
+   if ((flags & PAGES_LOCKED) && !(applied & PAGES_LOCKED)) {
+      if (VirtualLock(ptr, bytes)) applied |= PAGES_LOCKED;
+      else                         warnings += "pages lock failed (working set is too small); ";
+   }
+   // pre-fault all pages
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   for (size_t i = 0; i < bytes; i += info.dwPageSize)
+      ((volatile char*)ptr)[i] = 0;
+   return ptr;
+}
+//+------------------------------------------------------------------+
+//| Release pages                                                    |
+//+------------------------------------------------------------------+
+void PageMemory::Free(void* ptr, size_t, unsigned) {
+   if (ptr) VirtualFree(ptr, 0, MEM_RELEASE);
+}
+#else
+//+------------------------------------------------------------------+
+//| Map anonymous pages, explicit huge pages need reserved hugetlbfs |
+//| pages, otherwise transparent huge pages are requested            |
+//+------------------------------------------------------------------+
+void* PageMemory::Allocate(size_t bytes, unsigned flags, unsigned& applied, std::string& warnings) {
+   void* ptr = MAP_FAILED;
+   applied   = 0;
+   if (bytes == 0) bytes = 1;
+#ifdef MAP_HUGETLB
+   if (flags & PAGES_HUGE) {
+      ptr = mmap(NULL, (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+      if (ptr != MAP_FAILED) applied |= PAGES_HUGE;
+   }
+#endif
+   if (ptr == MAP_FAILED) {
+      ptr = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+      if (ptr == MAP_FAILED) return NULL;
+#ifdef MADV_HUGEPAGE
+      if ((flags & PAGES_HUGE) && madvise(ptr, bytes, MADV_HUGEPAGE) == 0)
+         warnings += "hugetlb pages are not reserved, transparent huge pages requested; ";
+      else
+#endif
+      if (flags & PAGES_HUGE)
+         warnings += "huge pages are not available; ";
+   }
+   if (flags & PAGES_LOCKED) {
+      if (mlock(ptr, bytes) == 0) applied |= PAGES_LOCKED;
+      else                        warnings += "mlock failed (check RLIMIT_MEMLOCK); ";
+   }
+   // pre-fault all pages, MAP_POPULATE is a hint only
+   long page = sysconf(_SC_PAGESIZE);
+   for (size_t i = 0; i < bytes; i += size_t(page))
+      ((volatile char*)ptr)[i] = 0;
+   return ptr;
+}
+//+------------------------------------------------------------------+
+//| Unmap pages                                                      |
+//+------------------------------------------------------------------+
+void PageMemory::Free(void* ptr, size_t bytes, unsigned applied) {
+   if (!ptr) return;
+   if (bytes == 0) bytes = 1;
+   if (applied & PAGES_HUGE)
+      bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+   munmap(ptr, bytes);
+}
+#endif
+//+------------------------------------------------------------------+
@@ -0,0 +1,97 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+//+------------------------------------------------------------------+
+//| Pages allocation flags                                           |
+//+------------------------------------------------------------------+
+enum EnPageFlags {
+   PAGES_HUGE   = 1,                         // huge pages, falls back to regular pages
+   PAGES_LOCKED = 2,                         // lock pages in memory
+};
+//+------------------------------------------------------------------+
+//| Pages allocation from the OS, memory is pre-faulted              |
+//+------------------------------------------------------------------+
+class PageMemory {
+public:
+   // returns NULL on failure, warnings describe flags which were not applied
+   static void*      Allocate(size_t bytes, unsigned flags, unsigned& applied, std::string& warnings);
+   static void       Free(void* ptr, size_t bytes, unsigned applied);
+};
+//+------------------------------------------------------------------+
+//| Array of trivial values in pre-faulted pages, vector-like        |
+//| interface, size changes within the capacity don't touch memory   |
+//+------------------------------------------------------------------+
+template<class T>
+class PageBuffer {
+   static_assert(std::is_trivially_copyable_v<T>, "PageBuffer keeps trivial values only");
+
+private:
+   T*                m_data;
+   size_t            m_size;
+   size_t            m_capacity;
+   unsigned          m_flags;                // requested flags
+   unsigned          m_applied;              // flags of the allocated pages
+
+public:
+                     PageBuffer() : m_data(NULL), m_size(0), m_capacity(0), m_flags(0), m_applied(0) {}
+                    ~PageBuffer()            { Free(); }
+                     PageBuffer(const PageBuffer&) = delete;
+   PageBuffer&       operator=(const PageBuffer&) = delete;
+
+   // allocate and pre-fault the capacity, size is set to the capacity
+   bool              Allocate(size_t capacity, unsigned flags, std::string& warnings) {
+      Free();
+      m_flags = flags;
+      m_data  = (T*)PageMemory::Allocate(capacity * sizeof(T), flags, m_applied, warnings);
+      if (!m_data) return false;
+      m_size = m_capacity = capacity;
+      return true;
+   }
+   void              Free() {
+      if (m_data) PageMemory::Free(m_data, m_capacity * sizeof(T), m_applied);
+      m_data     = NULL;
+      m_size     = m_capacity = 0;
+   }
+   // growth beyond the capacity reallocates with the same flags and copies values,
+   // false if memory is exhausted, the buffer is left unchanged then
+   bool              resize(size_t size) {
+      if (size > m_capacity) {
+         std::string warnings;
+         size_t      capacity = m_capacity * 2 > size ? m_capacity * 2 : size;
+         unsigned    applied  = 0;
+         T*          data     = (T*)PageMemory::Allocate(capacity * sizeof(T), m_flags, applied, warnings);
+         if (!data) return false;
+         if (m_data) {
+            memcpy(data, m_data, m_size * sizeof(T));
+            PageMemory::Free(m_data, m_capacity * sizeof(T), m_applied);
+         }
+         m_data     = data;
+         m_capacity = capacity;
+         m_applied  = applied;
+      }
+      m_size = size;
+      return true;
+   }
+
+   size_t            size() const            { return m_size;     }
+   size_t            capacity() const        { return m_capacity; }
+   bool              empty() const           { return m_size == 0; }
+   unsigned          Applied() const         { return m_applied;  }
+   T*                data()                  { return m_data; }
+   const T*          data() const            { return m_data; }
+   T*                begin()                 { return m_data; }
+   T*                end()                   { return m_data + m_size; }
+   const T*          begin() const           { return m_data; }
+   const T*          end() const             { return m_data + m_size; }
+   T&                operator[](size_t i)       { return m_data[i]; }
+   const T&          operator[](size_t i) const { return m_data[i]; }
+};
+//+------------------------------------------------------------------+
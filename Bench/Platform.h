@@ -0,0 +1,37 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+//+------------------------------------------------------------------+
+//| Windows                                                          |
+//+------------------------------------------------------------------+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+
+#define BENCH_PATH_SEP     "\\"              // path separator
+#define BENCH_LIB_EXT      ".dll"            // plugins extension
+#define BENCH_LIB_EXT_ALT  ".so"             // extension of the other platform plugins
+//+------------------------------------------------------------------+
+//| POSIX, names of the Windows types used by the plugins API        |
+//+------------------------------------------------------------------+
+#else
+#include <cstdint>
+#include <climits>
+#include <dlfcn.h>
+
+typedef uint64_t           UINT64;
+typedef const char*        LPCSTR;
+typedef void*              HMODULE;
+
+#ifndef MAX_PATH
+#define MAX_PATH           PATH_MAX
+#endif
+
+#define BENCH_PATH_SEP     "/"               // path separator
+#define BENCH_LIB_EXT      ".so"             // plugins extension
+#define BENCH_LIB_EXT_ALT  ".dll"            // extension of the other platform plugins
+#endif
+//+------------------------------------------------------------------+
@@ -0,0 +1,305 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "Results.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+// yaml-cpp reads JSON baselines
+#define YAML_CPP_STATIC_DEFINE
+#include <yaml-cpp/yaml.h>
+#ifndef _WIN32
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+//+------------------------------------------------------------------+
+//| Write results, format is selected by the file extension          |
+//+------------------------------------------------------------------+
+bool Results::Write(const std::string& path, const TSummaries& results) {
+   std::ofstream out(path, std::ios::binary);
+   if (!out) {
+      std::cerr << "Results: failed to create " << path << std::endl;
+      return false;
+   }
+   bool csv = path.size() > 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+   bool res = csv ? WriteCsv(out, results) : WriteJson(out, results);
+   out.close();
+   if (!res || !out) {
+      std::cerr << "Results: failed to write " << path << std::endl;
+      return false;
+   }
+   std::cout << "Results saved to " << path << std::endl;
+   return true;
+}
+//+------------------------------------------------------------------+
+//| JSON with environment, configs, stats and histograms             |
+//+------------------------------------------------------------------+
+bool Results::WriteJson(std::ostream& out, const TSummaries& results) {
+   out << std::setprecision(17);
+   out << "{\n  \"format\": " << FORMAT_VERSION << ",\n"
+       << "  \"environment\": {\n"
+       << "    \"host\": \""   << Escape(Host())   << "\",\n"
+       << "    \"system\": \"" << Escape(System()) << "\",\n"
+       << "    \"cpu\": \""    << Escape(Cpu())    << "\",\n"
+       << "    \"cpus\": "     << std::thread::hardware_concurrency() << ",\n"
+       << "    \"clock\": \""  << Clock::Name(ExtClock.Type()) << "\",\n"
+       << "    \"frequency\": " << ExtClock.Frequency() << ",\n"
+       << "    \"overhead_ns\": " << ExtClock.Overhead() << ",\n"
+       << "    \"overhead_subtracted\": " << (ExtClock.Subtract() ? "true" : "false") << ",\n"
+       << "    \"time\": \""   << Now() << "\"\n"
+       << "  },\n"
+       << "  \"tests\": [";
+   for (size_t i = 0; i < results.size(); i++) {
+      const auto& r = results[i];
+      out << (i ? ",\n" : "\n")
+          << "    {\n"
+          << "      \"name\": \"" << Escape(r.cfg.name) << "\",\n"
+          << "      \"revision\": \"" << Escape(r.revision) << "\",\n"
+          << "      \"config\": {\n"
+          << "        \"load\": \"" << Escape(r.cfg.library) << "\",\n"
+          << "        \"init\": \"" << Escape(r.cfg.thread_default.initializer) << "\",\n"
+          << "        \"context_init\": \"" << Escape(r.cfg.thread_default.context) << "\",\n"
+          << "        \"concurrency\": " << r.cfg.concurrency << ",\n"
+          << "        \"samples\": " << (r.cfg.samples_auto ? "\"auto\"" : std::to_string(r.cfg.samples)) << ",\n"
+          << "        \"duration_ns\": " << r.cfg.duration << ",\n"
+          << "        \"batch\": " << r.cfg.batch << ",\n"
+          << "        \"recording\": \"" << (r.cfg.recording == RECORDING_HISTOGRAM ? "histogram" : "samples") << "\",\n"
+          << "        \"rate\": " << r.cfg.rate << ",\n"
+          << "        \"affinity\": \"" << Topology::Name(r.cfg.affinity) << "\"\n"
+          << "      },\n"
+          << "      \"threads\": " << r.threads << ",\n"
+          << "      \"batch\": " << r.batch << ",\n"
+          << "      \"calls\": " << r.calls << ",\n"
+          << "      \"elapsed_ns\": " << r.elapsed << ",\n"
+          << "      \"throughput\": " << r.throughput << ",\n"
+          << "      \"items\": " << r.items << ",\n"
+          << "      \"bytes\": " << r.bytes << ",\n"
+          << "      \"pooled\": ";
+      WriteStats(out, r.stats);
+      if (r.usage.valid)
+         out << ",\n      \"process\": {\"max_rss\": " << r.usage.max_rss << ", \"faults_minor\": " << r.usage.faults_minor
+             << ", \"faults_major\": " << r.usage.faults_major << ", \"switches_voluntary\": " << r.usage.switches_voluntary
+             << ", \"switches_involuntary\": " << r.usage.switches_involuntary << ", \"user_ns\": " << r.usage.user
+             << ", \"system_ns\": " << r.usage.system << "}";
+      out << ",\n      \"per_thread\": [";
+      for (size_t t = 0; t < r.thread_stats.size(); t++) {
+         out << (t ? ", " : "");
+         WriteStats(out, r.thread_stats[t]);
+      }
+      // non-empty buckets of the pooled durations
+      out << "],\n      \"histogram\": [";
+      bool first = true;
+      r.histogram.ForEach([&out, &first](uint64_t value, uint64_t count) {
+         out << (first ? "" : ",") << "[" << value << "," << count << "]";
+         first = false;
+      });
+      out << "]\n    }";
+   }
+   out << "\n  ]\n}\n";
+   return bool(out);
+}
+//+------------------------------------------------------------------+
+//| CSV row per thread and pooled row per test                       |
+//+------------------------------------------------------------------+
+bool Results::WriteCsv(std::ostream& out, const TSummaries& results) {
+   out << "test,revision,thread,threads,batch,count,min,max,mean,med,p90,p99,p999,p9999,stddev,mad,throughput\n";
+   out << std::setprecision(17);
+   auto row = [&out](const TestSummary& r, const std::string& thread, const SampleStats& s, double throughput) {
+      out << QuoteCsv(r.cfg.name) << "," << QuoteCsv(r.revision) << "," << thread << "," << r.threads << "," << r.batch << ","
+          << s.count << "," << s.min << "," << s.max << "," << s.mean << "," << s.med << "," << s.p90 << "," << s.p99 << ","
+          << s.p999 << "," << s.p9999 << "," << s.stddev << "," << s.mad << "," << throughput << "\n";
+   };
+   for (const auto& r : results) {
+      for (size_t t = 0; t < r.thread_stats.size(); t++)
+         row(r, std::to_string(t + 1), r.thread_stats[t], 0);
+      row(r, "all", r.stats, r.throughput);
+   }
+   return bool(out);
+}
+//+------------------------------------------------------------------+
+//| Stats object, nanoseconds per sample                             |
+//+------------------------------------------------------------------+
+void Results::WriteStats(std::ostream& out, const SampleStats& s) {
+   out << "{\"count\": " << s.count << ", \"min\": " << s.min << ", \"max\": " << s.max
+       << ", \"mean\": " << s.mean << ", \"med\": " << s.med << ", \"p90\": " << s.p90
+       << ", \"p99\": " << s.p99 << ", \"p999\": " << s.p999 << ", \"p9999\": " << s.p9999
+       << ", \"stddev\": " << s.stddev << ", \"mad\": " << s.mad
+       << ", \"med_low\": " << s.med_low << ", \"med_high\": " << s.med_high << "}";
+}
+//+------------------------------------------------------------------+
+//| Compare per-call distributions with the baseline results         |
+//+------------------------------------------------------------------+
+int Results::Compare(const std::string& baseline, const TSummaries& results, double threshold, double alpha) {
+   // CSV results have no histograms to compare
+   if (baseline.size() > 4 && baseline.compare(baseline.size() - 4, 4, ".csv") == 0) {
+      std::cerr << "Compare: baseline " << baseline << " is a CSV file, a JSON results file is required" << std::endl;
+      return -1;
+   }
+   YAML::Node root;
+   try {
+      root = YAML::LoadFile(baseline);
+      if (!root.IsMap() || !root["tests"] || !root["tests"].IsSequence()) {
+         std::cerr << "Compare: baseline " << baseline << " is not a JSON results file" << std::endl;
+         return -1;
+      }
+      return Compare(baseline, root["tests"], results, threshold, alpha);
+   }
+   catch (const std::exception& e) {
+      std::cerr << "Compare: failed to read baseline " << baseline << ": " << e.what() << std::endl;
+      return -1;
+   }
+}
+//+------------------------------------------------------------------+
+//| Compare results with the tests of the loaded baseline            |
+//+------------------------------------------------------------------+
+int Results::Compare(const std::string& baseline, const YAML::Node& tests, const TSummaries& results, double threshold, double alpha) {
+   int regressions = 0;
+   std::cout << "Compare with " << baseline << " (threshold " << std::fixed << std::setprecision(1) << threshold * 100.0
+             << "%, alpha " << std::defaultfloat << alpha << "):" << std::endl;
+   for (const auto& r : results) {
+      // find the test in the baseline
+      YAML::Node base;
+      for (size_t i = 0; i < tests.size(); i++)
+         if (tests[i]["name"].as<std::string>("") == r.cfg.name) base = tests[i];
+      std::cout << "  Test \"" << r.cfg.name << "\": ";
+      if (!base || !base["pooled"] || !base["histogram"] || base["histogram"].size() == 0 || r.histogram.Count() == 0) {
+         std::cout << "no baseline" << std::endl;
+         continue;
+      }
+      // per-call values, batches may differ
+      double                base_batch = base["batch"].as<double>(1.0);
+      double                batch      = double(r.batch);
+      Statistics::TWeighted before, after;
+      for (const auto& bucket : base["histogram"])
+         before.emplace_back(bucket[0].as<double>() / base_batch, bucket[1].as<uint64_t>());
+      r.histogram.ForEach([&after, batch](uint64_t value, uint64_t count) { after.emplace_back(value / batch, count); });
+
+      double z, p = Statistics::MannWhitney(after, before, z);
+      double med_before = base["pooled"]["med"].as<double>(0) / base_batch;
+      double med_after  = double(r.stats.med) / batch;
+      double change     = med_before > 0 ? med_after / med_before - 1.0 : 0;
+      const char* verdict = "no significant change";
+      if (p < alpha && change > threshold)  { verdict = "REGRESSION"; regressions++; }
+      if (p < alpha && change < -threshold)   verdict = "improvement";
+      std::cout << "median " << Test::FormatDuration(med_before) << " -> " << Test::FormatDuration(med_after)
+                << " (" << std::showpos << std::fixed << std::setprecision(1) << change * 100.0 << "%" << std::noshowpos
+                << "), p = " << std::scientific << std::setprecision(2) << p << std::defaultfloat << ", " << verdict;
+      if (!base["revision"].as<std::string>("").empty() || !r.revision.empty())
+         std::cout << ", revision " << base["revision"].as<std::string>("-") << " -> " << (r.revision.empty() ? "-" : r.revision);
+      std::cout << std::endl;
+   }
+   return regressions;
+}
+//+------------------------------------------------------------------+
+//| JSON string escaping                                             |
+//+------------------------------------------------------------------+
+std::string Results::Escape(const std::string& value) {
+   std::string res;
+   for (char c : value) {
+      switch (c) {
+         case '"':  res += "\\\""; break;
+         case '\\': res += "\\\\"; break;
+         case '\n': res += "\\n";  break;
+         case '\r': res += "\\r";  break;
+         case '\t': res += "\\t";  break;
+         default:
+            if ((unsigned char)c < 0x20) {
+               char code[8];
+               snprintf(code, sizeof(code), "\\u%04x", c);
+               res += code;
+            }
+            else
+               res += c;
+      }
+   }
+   return res;
+}
+//+------------------------------------------------------------------+
+//| CSV quoted field, embedded quotes are doubled (RFC 4180)         |
+//+------------------------------------------------------------------+
+std::string Results::QuoteCsv(const std::string& value) {
+   std::string res = "\"";
+   for (char c : value) {
+      if (c == '"') res += '"';
+      res += c;
+   }
+   return res + "\"";
+}
+#ifdef _WIN32
+//+------------------------------------------------------------------+
+//| Computer name                                                    |
+//+------------------------------------------------------------------+
+std::string Results::Host() {
+   char  name[MAX_COMPUTERNAME_LENGTH + 1] = "";
+   DWORD size = sizeof(name);
+   GetComputerNameA(name, &size);
+   return name;
+}
+//+------------------------------------------------------------------+
+//| Operating system                                                 |
+//+------------------------------------------------------------------+
+std::string Results::System() {
+   return "Windows";
+}
+//+------------------------------------------------------------------+
+//| Processor name                                                   |
+//+------------------------------------------------------------------+
+std::string Results::Cpu() {
+   const char* cpu = getenv("PROCESSOR_IDENTIFIER");
+   return cpu ? cpu : "";
+}
+#else
+//+------------------------------------------------------------------+
+//| Host name                                                        |
+//+------------------------------------------------------------------+
+std::string Results::Host() {
+   char name[256] = "";
+   gethostname(name, sizeof(name) - 1);
+   return name;
+}
+//+------------------------------------------------------------------+
+//| Operating system and kernel                                      |
+//+------------------------------------------------------------------+
+std::string Results::System() {
+   utsname info;
+   if (uname(&info) != 0) return "";
+   return std::string(info.sysname) + " " + info.release + " " + info.machine;
+}
+//+------------------------------------------------------------------+
+//| Processor model name                                             |
+//+------------------------------------------------------------------+
+std::string Results::Cpu() {
+   std::ifstream cpuinfo("/proc/cpuinfo");
+   std::string   line;
+   while (std::getline(cpuinfo, line))
+      if (line.compare(0, 10, "model name") == 0) {
+         size_t pos = line.find(':');
+         if (pos != std::string::npos) return line.substr(pos + 2);
+      }
+   return "";
+}
+#endif
+//+------------------------------------------------------------------+
+//| UTC time of the run                                              |
+//+------------------------------------------------------------------+
+std::string Results::Now() {
+   char        buffer[32];
+   std::time_t now = std::time(NULL);
+   std::tm     utc;
+#ifdef _WIN32
+   gmtime_s(&utc, &now);
+#else
+   gmtime_r(&now, &utc);
+#endif
+   std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+   return buffer;
+}
+//+------------------------------------------------------------------+
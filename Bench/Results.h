@@ -0,0 +1,43 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include "Test.h"
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace YAML { class Node; }
+
+//+------------------------------------------------------------------+
+//| Results file of all tests of the run and baseline comparison.    |
+//| JSON keeps config, environment, per-thread and pooled stats and  |
+//| pooled histogram, CSV keeps stats rows only.                     |
+//+------------------------------------------------------------------+
+class Results {
+public:
+   typedef std::vector<TestSummary> TSummaries;
+
+   static constexpr int    FORMAT_VERSION    = 1;
+   static constexpr double THRESHOLD_DEFAULT = 0.05;   // relative median change
+   static constexpr double ALPHA_DEFAULT     = 0.01;   // significance level
+
+   static bool       Write(const std::string& path, const TSummaries& results);
+   // returns number of regressions, -1 if baseline can't be read
+   static int        Compare(const std::string& baseline, const TSummaries& results, double threshold, double alpha);
+
+private:
+   static int        Compare(const std::string& baseline, const YAML::Node& tests, const TSummaries& results, double threshold, double alpha);
+   static bool       WriteJson(std::ostream& out, const TSummaries& results);
+   static bool       WriteCsv(std::ostream& out, const TSummaries& results);
+   static void       WriteStats(std::ostream& out, const SampleStats& stats);
+   static std::string Escape(const std::string& value);
+   static std::string QuoteCsv(const std::string& value);
+   static std::string Host();
+   static std::string System();
+   static std::string Cpu();
+   static std::string Now();
+};
+//+------------------------------------------------------------------+
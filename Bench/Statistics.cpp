@@ -0,0 +1,296 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "Statistics.h"
+#include <algorithm>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <utility>
+#include <tuple>
+
+//+------------------------------------------------------------------+
+//| Nearest-rank percentile rank [1..count]                          |
+//+------------------------------------------------------------------+
+static uint64_t PercentileRank(uint64_t count, double percentile) {
+   uint64_t rank = uint64_t(std::ceil(percentile / 100.0 * count));
+   if (rank < 1)     rank = 1;
+   if (rank > count) rank = count;
+   return rank;
+}
+//+------------------------------------------------------------------+
+//| Statistics of samples                                            |
+//+------------------------------------------------------------------+
+void Statistics::Calculate(uint64_t* values, size_t count, SampleStats& stats) {
+   Reset(stats);
+   if (!values || count == 0) return;
+
+   // everything below relies on the order
+   std::sort(values, values + count);
+   auto at_rank = [values](uint64_t rank) { return values[rank - 1]; };
+
+   // moments
+   stats.count = count;
+   stats.min   = values[0];
+   stats.max   = values[count - 1];
+   for (size_t i = 0; i < count; i++)
+      stats.sum += values[i];
+   stats.mean = double(stats.sum) / count;
+   if (count > 1) {
+      double sq = 0;
+      for (size_t i = 0; i < count; i++)
+         sq += (values[i] - stats.mean) * (values[i] - stats.mean);
+      stats.stddev = std::sqrt(sq / (count - 1));
+   }
+   stats.cv = stats.mean > 0 ? stats.stddev / stats.mean : 0;
+
+   // median and percentiles
+   if (count % 2) stats.med = values[count / 2];
+   else           stats.med = (values[count / 2 - 1] + values[count / 2]) / 2;
+   stats.p90   = at_rank(PercentileRank(count, 90.0));
+   stats.p99   = at_rank(PercentileRank(count, 99.0));
+   stats.p999  = at_rank(PercentileRank(count, 99.9));
+   stats.p9999 = at_rank(PercentileRank(count, 99.99));
+
+   // median absolute deviation, deviations grow in both directions from the median
+   ptrdiff_t left  = std::upper_bound(values, values + count, stats.med) - values - 1;
+   ptrdiff_t right = left + 1;
+   for (size_t k = 0; k < (count + 1) / 2; k++) {
+      if (right >= ptrdiff_t(count) || (left >= 0 && stats.med - values[left] <= values[right] - stats.med))
+         stats.mad = stats.med - values[left--];
+      else
+         stats.mad = values[right++] - stats.med;
+   }
+
+   // Tukey fences
+   double q1  = double(at_rank(PercentileRank(count, 25.0)));
+   double q3  = double(at_rank(PercentileRank(count, 75.0)));
+   double iqr = q3 - q1;
+   auto outside = [values, count](double low, double high) {
+      size_t below = std::lower_bound(values, values + count, low,  [](uint64_t v, double x) { return v < x; }) - values;
+      size_t above = values + count - std::upper_bound(values, values + count, high, [](double x, uint64_t v) { return x < v; });
+      return uint64_t(below + above);
+   };
+   stats.outliers_extreme = outside(q1 - 3.0 * iqr, q3 + 3.0 * iqr);
+   stats.outliers_mild    = outside(q1 - 1.5 * iqr, q3 + 1.5 * iqr) - stats.outliers_extreme;
+
+   // confidence interval of the median
+   MedianCI(count, at_rank, stats);
+}
+//+------------------------------------------------------------------+
+//| Statistics of histogram, values are sub-bucket middles           |
+//+------------------------------------------------------------------+
+void Statistics::Calculate(const Histogram& histogram, SampleStats& stats) {
+   typedef std::vector<std::pair<uint64_t, uint64_t>> TBuckets;
+
+   Reset(stats);
+   if (histogram.Count() == 0) return;
+
+   // non-empty sub-buckets as value/count pairs
+   TBuckets buckets;
+   histogram.ForEach([&buckets](uint64_t value, uint64_t count) { buckets.emplace_back(value, count); });
+
+   // moments, count/sum/min/max are exact
+   stats.count = histogram.Count();
+   stats.sum   = histogram.Sum();
+   stats.min   = histogram.Min();
+   stats.max   = histogram.Max();
+   stats.mean  = double(stats.sum) / stats.count;
+   if (stats.count > 1) {
+      double sq = 0;
+      for (const auto& b : buckets)
+         sq += (b.first - stats.mean) * (b.first - stats.mean) * b.second;
+      stats.stddev = std::sqrt(sq / (stats.count - 1));
+   }
+   stats.cv = stats.mean > 0 ? stats.stddev / stats.mean : 0;
+
+   // median and percentiles
+   stats.med   = histogram.Percentile(50.0);
+   stats.p90   = histogram.Percentile(90.0);
+   stats.p99   = histogram.Percentile(99.0);
+   stats.p999  = histogram.Percentile(99.9);
+   stats.p9999 = histogram.Percentile(99.99);
+
+   // median absolute deviation
+   TBuckets deviations;
+   deviations.reserve(buckets.size());
+   for (const auto& b : buckets)
+      deviations.emplace_back(b.first > stats.med ? b.first - stats.med : stats.med - b.first, b.second);
+   std::sort(deviations.begin(), deviations.end());
+   uint64_t total = 0;
+   for (const auto& d : deviations) {
+      total += d.second;
+      if (total >= (stats.count + 1) / 2) {
+         stats.mad = d.first;
+         break;
+      }
+   }
+
+   // Tukey fences
+   double q1  = double(histogram.Percentile(25.0));
+   double q3  = double(histogram.Percentile(75.0));
+   double iqr = q3 - q1;
+   for (const auto& b : buckets) {
+      if      (b.first < q1 - 3.0 * iqr || b.first > q3 + 3.0 * iqr) stats.outliers_extreme += b.second;
+      else if (b.first < q1 - 1.5 * iqr || b.first > q3 + 1.5 * iqr) stats.outliers_mild    += b.second;
+   }
+
+   // confidence interval of the median
+   MedianCI(stats.count, [&histogram](uint64_t rank) { return histogram.ValueAtRank(rank); }, stats);
+}
+//+------------------------------------------------------------------+
+//| Universal Scalability Law:                                       |
+//| X(N) = lambda N / (1 + sigma(N-1) + kappa N(N-1))                |
+//| lambda is the single thread throughput, sigma is contention and  |
+//| kappa is coherency. With C(N)=X(N)/lambda the model is linear:   |
+//| N/C(N)-1 = sigma(N-1) + kappa N(N-1), fitted by least squares.   |
+//| Without a single thread level lambda is extrapolated from the    |
+//| smallest level as if it scaled linearly.                         |
+//+------------------------------------------------------------------+
+bool Statistics::FitUSL(const size_t* levels, const double* throughput, size_t count,
+                        double& sigma, double& kappa, double& lambda) {
+   sigma = kappa = lambda = 0;
+   if (count < 3) return false;
+   // single thread throughput
+   size_t lowest = 0;
+   for (size_t i = 1; i < count; i++)
+      if (levels[i] < levels[lowest]) lowest = i;
+   if (levels[lowest] < 1 || throughput[lowest] <= 0) return false;
+   lambda = throughput[lowest] / double(levels[lowest]);
+
+   // normal equations of the two regressors without intercept
+   double s11 = 0, s12 = 0, s22 = 0, s1y = 0, s2y = 0;
+   for (size_t i = 0; i < count; i++) {
+      if (throughput[i] <= 0) continue;
+      double n  = double(levels[i]);
+      double x1 = n - 1, x2 = n * (n - 1);
+      double y  = n * lambda / throughput[i] - 1;
+      s11 += x1 * x1;  s12 += x1 * x2;  s22 += x2 * x2;
+      s1y += x1 * y;   s2y += x2 * y;
+   }
+   double det = s11 * s22 - s12 * s12;
+   if (std::fabs(det) < 1e-12) return false;
+   sigma = (s1y * s22 - s2y * s12) / det;
+   kappa = (s2y * s11 - s1y * s12) / det;
+   return true;
+}
+//+------------------------------------------------------------------+
+//| Mann-Whitney U with tie correction and normal approximation.     |
+//| Values are weighted by counts, so histograms are compared as     |
+//| samples without expanding them.                                  |
+//+------------------------------------------------------------------+
+double Statistics::MannWhitney(const TWeighted& a, const TWeighted& b, double& z) {
+   // value, count in a, count in b
+   typedef std::vector<std::tuple<double, uint64_t, uint64_t>> TMerged;
+   TMerged merged;
+   double  n1 = 0, n2 = 0;
+   for (const auto& v : a) { merged.emplace_back(v.first, v.second, 0); n1 += double(v.second); }
+   for (const auto& v : b) { merged.emplace_back(v.first, 0, v.second); n2 += double(v.second); }
+   z = 0;
+   if (n1 == 0 || n2 == 0) return 1.0;
+   std::sort(merged.begin(), merged.end());
+
+   // rank sum of a, equal values get the average rank
+   double rank = 0, rank_sum = 0, ties = 0;
+   for (size_t i = 0; i < merged.size();) {
+      double   value = std::get<0>(merged[i]);
+      uint64_t in_a  = 0, in_b = 0;
+      for (; i < merged.size() && std::get<0>(merged[i]) == value; i++) {
+         in_a += std::get<1>(merged[i]);
+         in_b += std::get<2>(merged[i]);
+      }
+      double t = double(in_a + in_b);
+      rank_sum += double(in_a) * (rank + (t + 1) / 2);
+      ties     += t * t * t - t;
+      rank     += t;
+   }
+   double n     = n1 + n2;
+   double u     = rank_sum - n1 * (n1 + 1) / 2;
+   double var   = n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1)));
+   if (var <= 0) return 1.0;
+   z = (u - n1 * n2 / 2) / std::sqrt(var);
+   return std::erfc(std::fabs(z) / std::sqrt(2.0));
+}
+//+------------------------------------------------------------------+
+//| Mean difference and geometric mean ratio of pairs with 95%       |
+//| percentile bootstrap intervals, pairs are resampled together so  |
+//| the drift shared by both values of a pair cancels out            |
+//+------------------------------------------------------------------+
+void Statistics::Paired(const double* a, const double* b, size_t count, PairedStats& stats) {
+   stats = PairedStats{};
+   if (!a || !b || count == 0) return;
+   std::vector<double> diffs(count), logs(count);
+   for (size_t i = 0; i < count; i++) {
+      diffs[i] = b[i] - a[i];
+      logs[i]  = (a[i] > 0 && b[i] > 0) ? std::log(a[i] / b[i]) : 0;
+      if (b[i] < a[i]) stats.wins++;
+   }
+   auto mean = [count](const std::vector<double>& values) {
+      double sum = 0;
+      for (double v : values) sum += v;
+      return sum / double(count);
+   };
+   stats.count = count;
+   stats.diff  = stats.diff_low  = stats.diff_high  = mean(diffs);
+   stats.ratio = stats.ratio_low = stats.ratio_high = std::exp(mean(logs));
+   if (count < 2) return;
+
+   // the same resampled indices for both means
+   std::mt19937_64                       rng(count);
+   std::uniform_int_distribution<size_t> index(0, count - 1);
+   std::vector<double>                   diff_means(BOOTSTRAP_RESAMPLES), log_means(BOOTSTRAP_RESAMPLES);
+   for (size_t r = 0; r < BOOTSTRAP_RESAMPLES; r++) {
+      double diff_sum = 0, log_sum = 0;
+      for (size_t i = 0; i < count; i++) {
+         size_t k = index(rng);
+         diff_sum += diffs[k];
+         log_sum  += logs[k];
+      }
+      diff_means[r] = diff_sum / double(count);
+      log_means[r]  = log_sum / double(count);
+   }
+   std::sort(diff_means.begin(), diff_means.end());
+   std::sort(log_means.begin(), log_means.end());
+   stats.diff_low   = diff_means[size_t(BOOTSTRAP_RESAMPLES * 0.025)];
+   stats.diff_high  = diff_means[size_t(BOOTSTRAP_RESAMPLES * 0.975) - 1];
+   stats.ratio_low  = std::exp(log_means[size_t(BOOTSTRAP_RESAMPLES * 0.025)]);
+   stats.ratio_high = std::exp(log_means[size_t(BOOTSTRAP_RESAMPLES * 0.975) - 1]);
+}
+//+------------------------------------------------------------------+
+//| Clear stats                                                      |
+//+------------------------------------------------------------------+
+void Statistics::Reset(SampleStats& stats) {
+   stats = SampleStats{};
+}
+//+------------------------------------------------------------------+
+//| 95% percentile bootstrap confidence interval of the median.      |
+//| Median of n values resampled from the sorted sample is its k-th  |
+//| element where k/n is the k-th order statistic of n uniforms,     |
+//| i.e. Beta(k, n-k+1), so each resample costs O(1) instead of O(n) |
+//+------------------------------------------------------------------+
+template<class TValueAtRank>
+void Statistics::MedianCI(uint64_t count, TValueAtRank value_at_rank, SampleStats& stats) {
+   if (count < 2) {
+      stats.med_low = stats.med_high = stats.med;
+      return;
+   }
+   // fixed seed, the same data gives the same interval
+   std::mt19937_64                 rng(count);
+   double                          k = double((count + 1) / 2);
+   std::gamma_distribution<double> gamma_a(k, 1.0);
+   std::gamma_distribution<double> gamma_b(double(count) - k + 1.0, 1.0);
+
+   // values are ordered by rank, so quantiles of the resampled medians are taken on ranks
+   std::vector<uint64_t> ranks(BOOTSTRAP_RESAMPLES);
+   for (auto& rank : ranks) {
+      double a = gamma_a(rng), b = gamma_b(rng);
+      rank = uint64_t(a / (a + b) * count) + 1;
+      if (rank > count) rank = count;
+   }
+   std::sort(ranks.begin(), ranks.end());
+   stats.med_low  = value_at_rank(ranks[size_t(BOOTSTRAP_RESAMPLES * 0.025)]);
+   stats.med_high = value_at_rank(ranks[size_t(BOOTSTRAP_RESAMPLES * 0.975) - 1]);
+}
+//+------------------------------------------------------------------+
@@ -0,0 +1,74 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include "Histogram.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+//+------------------------------------------------------------------+
+//| Statistics of a set of samples, all values are in nanoseconds    |
+//+------------------------------------------------------------------+
+struct SampleStats {
+   uint64_t       count;                     // number of samples
+   uint64_t       sum;                       // sum of durations
+   uint64_t       min;
+   uint64_t       max;
+   double         mean;
+   double         stddev;                    // standard deviation
+   double         cv;                        // coefficient of variation, stddev/mean
+   uint64_t       med;                       // median
+   uint64_t       mad;                       // median absolute deviation
+   uint64_t       p90;
+   uint64_t       p99;
+   uint64_t       p999;
+   uint64_t       p9999;
+   uint64_t       med_low;                   // 95% confidence interval of the median
+   uint64_t       med_high;
+   uint64_t       outliers_mild;             // outside of the 1.5 IQR Tukey fences
+   uint64_t       outliers_extreme;          // outside of the 3 IQR Tukey fences
+};
+//+------------------------------------------------------------------+
+//| Paired comparison of two variants measured in the same rounds    |
+//+------------------------------------------------------------------+
+struct PairedStats {
+   size_t         count;                     // number of pairs
+   double         diff;                      // mean difference b - a
+   double         diff_low;                  // 95% bootstrap confidence interval of the difference
+   double         diff_high;
+   double         ratio;                     // geometric mean of a/b, speedup of b over a
+   double         ratio_low;                 // 95% bootstrap confidence interval of the ratio
+   double         ratio_high;
+   size_t         wins;                      // pairs where b is less than a
+};
+//+------------------------------------------------------------------+
+//| Statistics calculation                                           |
+//+------------------------------------------------------------------+
+class Statistics {
+public:
+   typedef std::vector<std::pair<double, uint64_t>> TWeighted;   // value and its count
+
+   static constexpr size_t BOOTSTRAP_RESAMPLES = 2000;
+
+   // sorts values in place
+   static void       Calculate(uint64_t* values, size_t count, SampleStats& stats);
+   static void       Calculate(const Histogram& histogram, SampleStats& stats);
+   // Universal Scalability Law fit of throughput at concurrency levels
+   static bool       FitUSL(const size_t* levels, const double* throughput, size_t count,
+                            double& sigma, double& kappa, double& lambda);
+   // Mann-Whitney U test of two weighted samples, returns two-sided p-value,
+   // z is positive if values of a are greater
+   static double     MannWhitney(const TWeighted& a, const TWeighted& b, double& z);
+   // paired difference and ratio of positive values a[i] and b[i]
+   static void       Paired(const double* a, const double* b, size_t count, PairedStats& stats);
+
+private:
+   static void       Reset(SampleStats& stats);
+   template<class TValueAtRank>
+   static void       MedianCI(uint64_t count, TValueAtRank value_at_rank, SampleStats& stats);
+};
+//+------------------------------------------------------------------+
@@ -4,21 +4,34 @@
 //|                                    https://github.com/arthur-cpp |
 //+------------------------------------------------------------------+
 #include "Test.h"
+#include "TestLoop.h"
+#include "Trace.h"
 #include <iostream>
 #include <chrono>
 #include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <cmath>
+#include <climits>
+#include <cctype>
+#include <random>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
 
+// global variable
+std::atomic<bool> ExtStop{false};
 //+------------------------------------------------------------------+
 //|                                                                  |
 //+------------------------------------------------------------------+
-Test::Test() {}
+Test::Test() : m_batch(1), m_recording(RECORDING_SAMPLES), m_elapsed(0), m_finished(false), m_warmup_sync(false), m_arrived(0), m_created(0), m_schedule_anchor(0) {}
 //+------------------------------------------------------------------+
 //| Cleanup                                                          |
 //+------------------------------------------------------------------+
 Test::~Test() {
    // release tests instances
    for (auto test : m_tests) {
-      test->instance->Release();
+      if (test->instance) test->instance->Release();
       delete test;
    }
 
@@ -31,27 +44,76 @@ Test::~Test() {
 //|                                                                  |
 //+------------------------------------------------------------------+
 bool Test::Initialize(const TestCfg& cfg) {
-   // store test name
+   // store test name and configuration
    m_name = cfg.name;
+   m_cfg  = cfg;
    // load library
    if (!m_factory.Load(cfg.library.c_str(), cfg.thread_default.initializer.c_str())) {
       std::cerr << "Test \"" << m_name << "\" load failed" << std::endl;
       return false;
    }
+   // batches are available since API version 5 only
+   m_batch = cfg.batch;
+   if (m_batch > 1 && !m_factory.SupportsBatch()) {
+      std::cerr << "Test \"" << m_name << "\" plugin API version " << m_factory.Version()
+                << " does not support batches, batch size " << m_batch << " ignored" << std::endl;
+      m_batch = 1;
+   }
+   m_recording = cfg.recording;
+   // CPUs of the threads
+   std::vector<int> cpus = ExtTopology.Layout(cfg.affinity, cfg.affinity_offset + cfg.concurrency, cfg.affinity_cpus);
+   cpus.erase(cpus.begin(), cpus.begin() + cfg.affinity_offset);
    
    // create and configure threads configurations
    for (size_t i = 0; i < cfg.concurrency; i++) {
       // create test instance
       RunTestCfg* test = new RunTestCfg();
       if (test) {
-         // store samples count
-         test->samples = cfg.samples;
+         test->index          = i;
+         // store samples count, time limited runs grow storage on the fly
+         test->samples        = (cfg.samples_auto || cfg.duration) ? SIZE_MAX : cfg.samples;
+         test->ci_width       = cfg.samples_auto ? cfg.ci_width : 0;
+         test->duration       = cfg.duration;
+         test->warmup         = cfg.warmup;
+         test->warmup_samples = cfg.warmup_samples;
+         test->converged      = false;
+         test->ci_recorded    = 0;
+         test->batch   = m_batch;
+         // recording memory is allocated by the thread itself before the start
+         test->recording     = m_recording;
+         test->precision     = cfg.precision;
+         test->ring          = cfg.ring;
+         test->pages         = cfg.pages;
+         test->buffer_failed = false;
+         test->faults_minor  = test->faults_major = 0;
+         test->faults_valid  = false;
+         test->progress_enabled = cfg.progress;
+         // performance counters are opened by the thread itself
+         test->counters_mask  = cfg.counters;
+         test->counters_scope = cfg.counters_scope;
+         // fixed rate is split between the running threads after the start barrier
+         test->interval = 0;
+         test->phase    = 0;
+         test->arrival  = cfg.arrival;
+         test->seed     = i + 1;
+         test->cpu      = cpus[i];
+         test->cpu_start= test->cpu_end = -1;
+         test->start    = 0;
+         // processed work, reported by the plugin or declared per call in the config
+         test->work_reported = cfg.items <= 0 && cfg.bytes <= 0 && m_factory.SupportsWork();
+         test->completed     = 0;
+         test->elapsed       = 0;
+         test->items         = test->bytes = 0;
+         // heap allocations are counted by the thread itself around every call
+         test->alloc_tracking = cfg.allocations && AllocTracker::Available();
+         test->allocs         = AllocCounters{};
          // set default context
          test->context_init = cfg.thread_default.context;
          // select initializer for thread using revolver principe
          if (cfg.threads.size() > 0) {
             auto& t = cfg.threads[i % cfg.threads.size()];
             test->initializer = t.initializer;
+            if (t.cpu >= 0) test->cpu = t.cpu;
             // detect context
             if (!t.context.empty()) {
                auto cit = cfg.contexts.find(t.context);
@@ -60,20 +122,9 @@ bool Test::Initialize(const TestCfg& cfg) {
                }
             }
          }
-         // create test instance
-         test->instance = m_factory.CreateTest(test->initializer.c_str(), CreateContext(test->context_init));
-         // store pointer on successfully created test instance
-         if (test->instance) {
-            m_tests.push_back(test);
-         }
-         else {
-            std::cout << "Test \"" << m_name << "\" failed to create test "
-                      << (test->context_init.empty() ? "" : ("(" + test->context_init + ") "))
-                      << (test->initializer.empty() ? "-" : test->initializer)
-                      << std::endl;
-            // release memory
-            delete test;
-         }
+         // test instance is created by the thread itself after pinning
+         test->instance = NULL;
+         m_tests.push_back(test);
       }
    }
 
@@ -94,7 +145,18 @@ UINT64 Test::CreateContext(const std::string& context_init) {
       }
       else {
          // context not created yet, create it and store to the map
-         ctx = m_factory.CreateContext(context_init.c_str());
+         auto node = m_cfg.context_nodes.find(context_init);
+         int  cpu  = node != m_cfg.context_nodes.end() ? ExtTopology.NodeCpu(node->second) : -1;
+         if (cpu >= 0) {
+            // memory of the context is first touched by a thread of the chosen node
+            std::thread creator([this, &ctx, &context_init, cpu]() {
+               Topology::Pin(cpu);
+               ctx = m_factory.CreateContext(context_init.c_str());
+            });
+            creator.join();
+         }
+         else
+            ctx = m_factory.CreateContext(context_init.c_str());
          if (ctx) {
             m_contexts[context_init] = ctx;
          }
@@ -106,125 +168,509 @@ UINT64 Test::CreateContext(const std::string& context_init) {
 //+------------------------------------------------------------------+
 //| Run all tests instances threads                                  |
 //+------------------------------------------------------------------+
-void Test::Run() {
+bool Test::Run() {
    std::barrier   sync_point(m_tests.size() + 1);
-   
+   bool           warmup = HasWarmup();
+
+   Launch(sync_point, warmup);
+   // start all threads simultaneously
+   sync_point.arrive_and_wait(); // here is all threads start
+   // measured part starts simultaneously after warmup of all threads
+   if (warmup) sync_point.arrive_and_wait();
+   Started();
+   // wait threads to complete
+   return Join();
+}
+//+------------------------------------------------------------------+
+//| Start threads, they wait for the start at the barrier            |
+//+------------------------------------------------------------------+
+void Test::Launch(std::barrier<>& sync, bool warmup_sync) {
+   bool warmup   = HasWarmup();
+   m_warmup_sync = warmup_sync;
+
    // check and run threads
    for (auto& test : m_tests) {
-      m_threads.emplace_back(&Test::RunTest, this, std::ref(sync_point), test);
+      m_threads.emplace_back(&Test::RunTest, this, std::ref(sync), test);
    }
 
    // print test started
    std::cout << "======================================================================================" << std::endl;
-   std::cout << "Test \"" << m_name << "\" started: " << m_tests.size() << " threads" << std::endl;
-
-   // start all threads simultaneously
-   auto start_time = std::chrono::high_resolution_clock::now();
-   sync_point.arrive_and_wait(); // here is all threads start
-   // wait threads to complete
+   std::cout << "Test \"" << m_name << "\" started: " << m_tests.size() << " threads";
+   if (m_batch > 1) std::cout << ", batches of " << m_batch << " calls, per-call timings";
+   if (m_cfg.rate > 0)
+      std::cout << ", " << (m_cfg.arrival == ARRIVAL_POISSON ? "poisson" : "constant") << " rate " << m_cfg.rate << " calls/s";
+   if (m_cfg.samples_auto)
+      std::cout << ", samples until median CI < " << m_cfg.ci_width * 100.0 << "% for " << FormatDuration(double(m_cfg.duration)) << " at most";
+   else if (m_cfg.duration)
+      std::cout << ", for " << FormatDuration(double(m_cfg.duration));
+   if (warmup) {
+      std::cout << ", warmup";
+      if (m_cfg.warmup)         std::cout << " " << FormatDuration(double(m_cfg.warmup));
+      if (m_cfg.warmup_samples) std::cout << " " << m_cfg.warmup_samples << " samples";
+   }
+   std::cout << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Threads are released, the measured part begins                   |
+//+------------------------------------------------------------------+
+void Test::Started(uint64_t deadline) {
+   size_t created = m_created.load();
+   if (created && created < m_tests.size())
+      std::cout << "Test \"" << m_name << "\" runs " << created << " of " << m_tests.size() << " threads" << std::endl;
+   m_start_time = std::chrono::high_resolution_clock::now();
+   // spinning threads start together after the pre-spin, the run is counted from the deadline
+   if (m_cfg.start == START_SPIN) {
+      uint64_t now = ClockSteady::Start();
+      if (!deadline) deadline = now + m_cfg.start_spin;
+      m_start_time += std::chrono::nanoseconds(deadline > now ? deadline - now : 0);
+      m_start_gate.deadline.store(deadline, std::memory_order_release);
+   }
+   // print status every second while running
+   if (m_cfg.progress && created) m_monitor = std::thread(&Test::Monitor, this);
+}
+//+------------------------------------------------------------------+
+//| Wait threads to complete                                         |
+//+------------------------------------------------------------------+
+bool Test::Join() {
    for (auto& t : m_threads) t.join();
    // calculate total time
    auto end_time = std::chrono::high_resolution_clock::now();
-   auto total_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+   // stop monitor
+   if (m_monitor.joinable()) {
+      {
+         std::lock_guard<std::mutex> lock(m_monitor_lock);
+         m_finished = true;
+      }
+      m_monitor_wake.notify_all();
+      m_monitor.join();
+   }
+   auto total_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - m_start_time).count();
+   m_elapsed = double(total_time);
+   // threads which failed to create test instances are not reported, the others keep their numbers
+   m_running.clear();
+   for (auto test : m_tests)
+      if (test->instance) m_running.push_back(test);
+   if (m_running.empty()) {
+      std::cerr << "Test \"" << m_name << "\" failed: no thread created a test instance" << std::endl;
+      return false;
+   }
 
    // print the overall test time
-   std::cout << "Test \"" << m_name << "\" completed in " << FormatDuration(total_time) << ":" << std::endl << std::endl;
-
+   std::cout << "Test \"" << m_name << "\" " << (ExtStop ? "interrupted" : "completed") << " in " << FormatDuration(total_time) << ":" << std::endl << std::endl;
+   return true;
 }
 //+------------------------------------------------------------------+
 //| Run single instance of test                                      |
 //+------------------------------------------------------------------+
 void Test::RunTest(std::barrier<>& sync, RunTestCfg* test) {
+   // pin the thread before it allocates anything
+   if (test && test->cpu >= 0 && !Topology::Pin(test->cpu)) {
+      std::lock_guard<std::mutex> lock(m_create_lock);
+      std::cerr << "Test \"" << m_name << "\" failed to pin thread to CPU " << test->cpu << std::endl;
+      test->cpu = -1;
+   }
+   // test instance memory is first touched by its own thread, plugins are not required to be thread-safe
+   if (test) {
+      std::lock_guard<std::mutex> lock(m_create_lock);
+      test->cpu_start = Topology::CurrentCpu();
+      test->instance  = m_factory.CreateTest(test->initializer.c_str(), CreateContext(test->context_init));
+      if (!test->instance)
+         std::cout << "Test \"" << m_name << "\" failed to create test "
+                   << (test->context_init.empty() ? "" : ("(" + test->context_init + ") "))
+                   << (test->initializer.empty() ? "-" : test->initializer)
+                   << std::endl;
+   }
+   // counters count the calling thread only, open them before the start
+   if (test && test->counters_mask)
+      test->counters.Open(test->counters_mask, test->counters_error);
+   // recording memory is allocated and pre-faulted out of the measured window
+   if (test && test->instance && !PrepareRecording(test)) {
+      test->buffer_failed = true;
+      test->instance->Release();
+      test->instance = NULL;
+   }
+   // threads ready to run share the rate, the rank interleaves their constant arrivals
+   size_t rank = (test && test->instance) ? m_created++ : 0;
    // synchronize start
+   m_arrived++;
    sync.arrive_and_wait();
 
    // check pointer
    if (!test) return;
-   // prepare size for timings
-   test->timings.resize(test->samples);
-
+   // all threads have created their instances, the rate is split between the running ones
+   if (test->instance && m_cfg.rate > 0) {
+      size_t created = m_created.load();
+      test->interval = ExtClock.Frequency() * double(created) * double(m_batch) / m_cfg.rate;
+      if (m_cfg.arrival == ARRIVAL_CONSTANT)
+         test->phase = test->interval * double(rank) / double(created);
+   }
+   // discard warmup samples, then wait the other threads to warm up
+   if (m_warmup_sync) {
+      if (test->instance && (test->warmup || test->warmup_samples)) Warmup(test);
+      m_arrived++;
+      sync.arrive_and_wait();
+   }
+   // threads leave the barrier staggered, spinning keeps them awake until the common deadline
+   if (m_cfg.start == START_SPIN) {
+      uint64_t deadline;
+      while ((deadline = m_start_gate.deadline.load(std::memory_order_acquire)) == 0)
+         ;
+      while (ClockSteady::Start() < deadline)
+         ;
+   }
+   test->start = ClockSteady::Start();
 
    // run test
    if (test->instance) {
-      auto instance = test->instance;
-      auto timings = test->timings.data();
-      // loop through
-      size_t count;
-      for (count = 0; count < test->samples; count++) {
-         // prepare before test
-         if (!instance->RunBefore()) break;
-         // record timestamp
-         LARGE_INTEGER qpc;
-         QueryPerformanceCounter(&qpc);
-
-         // run one sample of the test
-         auto start = std::chrono::high_resolution_clock::now();
-         if (!instance->Run()) break;
-         auto end = std::chrono::high_resolution_clock::now();
-
-         // store timing data (timestamp and duration)
-         auto t = timings + count;
-         t->timestamp = qpc.QuadPart;
-         t->duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+      size_t   count = 0;
+      uint64_t minor_start = 0, major_start = 0, minor_end = 0, major_end = 0;
+      test->faults_valid = PageFaults(minor_start, major_start);
+      bool   loop_counters = test->counters_scope == COUNTERS_SCOPE_LOOP;
+      // work done by warmup is not counted
+      UINT64 items_start = 0, bytes_start = 0;
+      if (test->work_reported) test->instance->Processed(&items_start, &bytes_start);
+      auto   loop_start = std::chrono::steady_clock::now();
+      if (test->alloc_tracking) AllocTracker::Reset();
+      if (loop_counters) test->counters.Enable();
+      // built-in tests run the samples loop specialized for their class
+      if (m_factory.Builtin()) count = static_cast<IBuiltinTest*>(test->instance)->RunLoop(*this, test);
+      else                     count = RunLoop(test, test->instance);
+      if (loop_counters) test->counters.Disable();
+      test->elapsed   = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - loop_start).count();
+      test->completed = count;
+      if (test->alloc_tracking) test->allocs = AllocTracker::Counters();
+      if (test->work_reported) {
+         UINT64 items_end = 0, bytes_end = 0;
+         test->instance->Processed(&items_end, &bytes_end);
+         test->items = items_end - items_start;
+         test->bytes = bytes_end - bytes_start;
+      }
+      else {
+         test->items = uint64_t(m_cfg.items * double(count * test->batch) + 0.5);
+         test->bytes = uint64_t(m_cfg.bytes * double(count * test->batch) + 0.5);
+      }
+      if (test->faults_valid && PageFaults(minor_end, major_end)) {
+         test->faults_minor = minor_end - minor_start;
+         test->faults_major = major_end - major_start;
+      }
+      test->counters.Read();
+      // cut to actual samples count, wrapped ring is rotated to the chronological order
+      if (test->recording == RECORDING_SAMPLES) {
+         if (test->ring && count > test->timings.size())
+            std::rotate(test->timings.begin(), test->timings.begin() + count % test->timings.size(), test->timings.end());
+         else
+            test->timings.resize(count);
+      }
+   }
+   test->cpu_end = Topology::CurrentCpu();
+}
+//+------------------------------------------------------------------+
+//| Allocate and pre-fault recording memory of the calling thread    |
+//+------------------------------------------------------------------+
+bool Test::PrepareRecording(RunTestCfg* test) {
+   // convergence checks of recorded samples count them in a histogram
+   if (test->ci_width > 0 && test->recording == RECORDING_SAMPLES && !test->ci_histogram.Initialize(test->precision))
+      return false;
+   // histogram is allocated once and doesn't grow with samples
+   if (test->recording == RECORDING_HISTOGRAM)
+      return test->histogram.Initialize(test->precision);
+   // exact size, ring, or a chunk growing while time limited run
+   size_t capacity = test->samples != SIZE_MAX ? test->samples : TIMINGS_CHUNK;
+   if (test->ring && (test->samples == SIZE_MAX || test->ring < test->samples))
+      capacity = test->ring;
+   if (!test->timings.Allocate(capacity, test->pages, test->buffer_warnings)) {
+      std::lock_guard<std::mutex> lock(m_create_lock);
+      std::cerr << "Test \"" << m_name << "\" failed to allocate " << capacity * sizeof(RunTestCfg::TimingEntry) << " bytes for samples" << std::endl;
+      return false;
+   }
+   return true;
+}
+//+------------------------------------------------------------------+
+//| Page faults of the calling thread                                |
+//+------------------------------------------------------------------+
+bool Test::PageFaults(uint64_t& minor, uint64_t& major) {
+#ifdef RUSAGE_THREAD
+   rusage usage;
+   if (getrusage(RUSAGE_THREAD, &usage) != 0) return false;
+   minor = uint64_t(usage.ru_minflt);
+   major = uint64_t(usage.ru_majflt);
+   return true;
+#else
+   // there are no per-thread counters
+   minor = major = 0;
+   return false;
+#endif
+}
+//+------------------------------------------------------------------+
+//| Run samples which are not recorded, until both limits are passed |
+//+------------------------------------------------------------------+
+void Test::Warmup(RunTestCfg* test) {
+   auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(test->warmup);
+   for (size_t count = 0; count < test->warmup_samples || std::chrono::steady_clock::now() < deadline; count++) {
+      if (ExtStop.load(std::memory_order_relaxed)) break;
+      if (!test->instance->RunBefore()) break;
+      if (!(test->batch > 1 ? test->instance->RunBatch(test->batch) : test->instance->Run())) break;
+      if (!test->instance->RunAfter()) break;
+   }
+}
+//+------------------------------------------------------------------+
+//| Print status of running threads every second                     |
+//+------------------------------------------------------------------+
+void Test::Monitor() {
+   uint64_t previous[TestProgress::BUCKETS] = {};
+   uint64_t previous_samples = 0;
+   auto     start = std::chrono::steady_clock::now();
 
-         // after test
-         if (!instance->RunAfter()) break;
+   std::unique_lock<std::mutex> lock(m_monitor_lock);
+   while (!m_monitor_wake.wait_for(lock, std::chrono::seconds(1), [this]() { return m_finished; })) {
+      // snapshot of all threads
+      uint64_t samples = 0, min = UINT64_MAX, max = 0, current[TestProgress::BUCKETS] = {}, recent = 0;
+      for (auto test : m_tests) {
+         samples += test->progress.samples.load(std::memory_order_relaxed);
+         min      = std::min(min, test->progress.min.load(std::memory_order_relaxed));
+         max      = std::max(max, test->progress.max.load(std::memory_order_relaxed));
+         for (int b = 0; b < TestProgress::BUCKETS; b++)
+            current[b] += test->progress.buckets[b].load(std::memory_order_relaxed);
       }
-      // cut to actual samples count
-      test->timings.resize(count);
+      // percentiles of the last second are upper bounds of the log2 buckets
+      uint64_t delta[TestProgress::BUCKETS];
+      for (int b = 0; b < TestProgress::BUCKETS; b++) {
+         delta[b]    = current[b] - previous[b];
+         previous[b] = current[b];
+         recent     += delta[b];
+      }
+      auto upper = [&delta, recent](double percentile) {
+         uint64_t rank = uint64_t(std::ceil(percentile / 100.0 * recent)), total = 0;
+         for (int b = 0; b < TestProgress::BUCKETS; b++)
+            if ((total += delta[b]) >= rank) return ExtClock.ToNs(b < 63 ? (2ull << b) : UINT64_MAX);
+         return uint64_t(0);
+      };
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      double batch   = double(m_batch);
+      std::cout << "Test \"" << m_name << "\" " << std::fixed << std::setprecision(0) << elapsed << "s: "
+                << samples << " samples, " << (samples - previous_samples) << "/s" << std::defaultfloat;
+      if (samples)
+         std::cout << ", min " << FormatDuration(ExtClock.ToNs(min) / batch) << ", max " << FormatDuration(ExtClock.ToNs(max) / batch);
+      if (recent)
+         std::cout << ", last second p50 < " << FormatDuration(upper(50.0) / batch) << ", p99 < " << FormatDuration(upper(99.0) / batch);
+      std::cout << std::endl;
+      previous_samples = samples;
    }
 }
 //+------------------------------------------------------------------+
+//| Check relative width of the median 95% confidence interval       |
+//+------------------------------------------------------------------+
+bool Test::Converged(RunTestCfg* test, size_t count) {
+   SampleStats stats;
+   if (test->recording == RECORDING_HISTOGRAM)
+      Statistics::Calculate(test->histogram, stats);
+   else {
+      // only samples since the previous check are added, so a check doesn't sort all samples,
+      // the ring keeps the last samples only
+      size_t size  = test->timings.size();
+      size_t first = std::max(test->ci_recorded, count > size ? count - size : 0);
+      for (size_t i = first; i < count; i++)
+         test->ci_histogram.Record(ExtClock.DurationNs(test->timings[i % size].duration));
+      test->ci_recorded = count;
+      Statistics::Calculate(test->ci_histogram, stats);
+   }
+   if (stats.med == 0) return false;
+   test->converged = double(stats.med_high - stats.med_low) / double(stats.med) < test->ci_width;
+   return test->converged;
+}
+//+------------------------------------------------------------------+
 //| Calculate statistics                                             |
 //+------------------------------------------------------------------+
 void Test::ProcessStatistics() {
-   // initialize overall threads stats
-   RunThreadStats tstats;
-   tstats.min = ULLONG_MAX;
-   tstats.max = 0;
-   tstats.sum = 0;
-   tstats.avg = 0;
-   tstats.med = 0;
+   // per-thread stats, pooled samples (or merged histograms) of all threads
+   std::vector<uint64_t> pooled;
+   Histogram             merged;
 
-   // calculate statistics
-   size_t counter = 1;
-   for (auto test : m_tests) {
-      RunThreadStats stats;
-      // process timings
-      ProcessTimings(counter++, test, stats);
-      // update overall stats
-      tstats.sum += stats.sum;
-      tstats.avg += stats.avg;
-      tstats.med += stats.med;
-      if (stats.min < tstats.min) tstats.min = stats.min;
-      if (stats.max > tstats.max) tstats.max = stats.max;
-   }
-   // print min/min, max/max, avg/avg, avg/med for all threads
-   if (counter > 0) {
-      tstats.avg = tstats.avg / counter;
-      tstats.med = tstats.med / counter;
+   m_stats.assign(m_running.size(), SampleStats{});
+   if (m_recording == RECORDING_SAMPLES) {
+      size_t total = 0;
+      for (auto test : m_running) total += test->timings.size();
+      pooled.resize(total);
+   }
 
-      std::cout << "  ["
-         << std::setw(2) << std::right << "**" << "] min/max/avg/med = "
-         << std::setw(10) << std::right << FormatDuration(tstats.min) << " / "
-         << std::setw(10) << std::right << FormatDuration(tstats.max) << " / "
-         << std::setw(10) << std::right << FormatDuration(tstats.avg) << " / "
-         << std::setw(10) << std::right << FormatDuration(tstats.med) << " / -"
-         << std::endl;
+   // calculate statistics of every thread
+   size_t offset = 0;
+   for (size_t i = 0; i < m_running.size(); i++) {
+      auto test = m_running[i];
+      if (m_recording == RECORDING_HISTOGRAM) {
+         Statistics::Calculate(test->histogram, m_stats[i]);
+         merged.Merge(test->histogram);
+      }
+      else {
+         // thread durations are placed to its part of pooled array
+         ProcessTimings(test, pooled.data() + offset);
+         Statistics::Calculate(pooled.data() + offset, test->timings.size(), m_stats[i]);
+         offset += test->timings.size();
+      }
+   }
+   // pooled stats are calculated on all samples, not on per-thread results
+   if (m_recording == RECORDING_HISTOGRAM) Statistics::Calculate(merged, m_pooled);
+   else                                    Statistics::Calculate(pooled.data(), pooled.size(), m_pooled);
+   // distribution of all samples for the results file
+   if (m_recording == RECORDING_HISTOGRAM) m_histogram = merged;
+   else {
+      m_histogram.Initialize(m_cfg.precision);
+      for (uint64_t duration : pooled)
+         m_histogram.Record(duration);
+   }
+
+   // the ring keeps the last samples, earlier ones are counted only
+   if (RingWrapped())
+      std::cout << "  Statistics of the last " << m_cfg.ring << " samples of every thread:" << std::endl;
+   // print min/max/avg/med (per call for batches)
+   for (size_t i = 0; i < m_running.size(); i++)
+      PrintStats(ThreadId(m_running[i]), m_stats[i], m_running[i]);
+   PrintStats("**", m_pooled, NULL);
+   // print percentiles
+   std::cout << std::endl;
+   for (size_t i = 0; i < m_running.size(); i++)
+      PrintPercentiles(ThreadId(m_running[i]), m_stats[i]);
+   PrintPercentiles("**", m_pooled);
+   // print dispersion
+   std::cout << std::endl;
+   for (size_t i = 0; i < m_running.size(); i++)
+      PrintDispersion(ThreadId(m_running[i]), m_stats[i]);
+   PrintDispersion("**", m_pooled);
+   // print statistics of the window where all threads were running
+   ProcessOverlap();
+   // print time series of throughput and latency
+   ProcessWindows();
+   // print threads placement
+   PrintPlacement();
+   // print performance counters per call
+   if (m_cfg.counters) {
+      uint64_t pooled_values[COUNTER_TOTAL] = {}, pooled_calls = 0;
+      uint32_t pooled_opened = 0;
+      std::cout << std::endl;
+      for (size_t i = 0; i < m_running.size(); i++) {
+         auto     test   = m_running[i];
+         uint32_t opened = 0;
+         if (!test->counters_error.empty())
+            std::cerr << "  [" << std::setw(2) << std::right << ThreadId(m_running[i]) << "] counters unavailable: " << test->counters_error << std::endl;
+         for (int c = 0; c < COUNTER_TOTAL; c++)
+            if (test->counters.IsOpened(EnCounter(c))) {
+               opened           |= PerfCounters::Mask(EnCounter(c));
+               pooled_values[c] += test->counters.Value(EnCounter(c));
+            }
+         uint64_t values[COUNTER_TOTAL];
+         for (int c = 0; c < COUNTER_TOTAL; c++)
+            values[c] = test->counters.Value(EnCounter(c));
+         PrintCounters(ThreadId(test), values, opened, test->completed * m_batch);
+         pooled_opened |= opened;
+         pooled_calls  += test->completed * m_batch;
+      }
+      PrintCounters("**", pooled_values, pooled_opened, pooled_calls);
    }
+
    // final statistics
-   std::cout << std::endl << "Test \"" << m_name << "\" summ run time " << FormatDuration(tstats.sum) << std::endl;
+   std::cout << std::endl << "Test \"" << m_name << "\" summ run time " << FormatDuration(double(m_pooled.sum))
+             << (RingWrapped() ? " of the recorded samples" : "") << std::endl;
+   PrintSamples();
+   PrintRate();
+   PrintWork();
+   PrintAllocations();
+   PrintFaults();
+   PrintStart();
    std::cout << "======================================================================================" << std::endl;
 
 }
 //+------------------------------------------------------------------+
+//| Results of the run, valid after ProcessStatistics                |
+//+------------------------------------------------------------------+
+TestSummary Test::Summary() const {
+   TestSummary summary;
+   summary.threads    = m_running.size();
+   summary.batch      = m_batch;
+   summary.calls      = 0;
+   for (auto test : m_running)
+      summary.calls += test->completed * m_batch;
+   summary.elapsed    = m_elapsed;
+   summary.throughput = m_elapsed > 0 ? double(summary.calls) * 1'000'000'000.0 / m_elapsed : 0;
+   summary.stats      = m_pooled;
+   summary.thread_stats = m_stats;
+   summary.histogram  = m_histogram;
+   summary.cfg        = m_cfg;
+   summary.revision   = m_factory.Revision();
+   summary.items      = summary.bytes = 0;
+   summary.usage      = ProcessUsage{};
+   summary.counters_opened = 0;
+   for (int c = 0; c < COUNTER_TOTAL; c++) {
+      summary.counters[c] = 0;
+      for (auto test : m_running)
+         if (test->counters.IsOpened(EnCounter(c))) {
+            summary.counters[c]     += test->counters.Value(EnCounter(c));
+            summary.counters_opened |= PerfCounters::Mask(EnCounter(c));
+         }
+   }
+   for (auto test : m_running) {
+      summary.items += test->items;
+      summary.bytes += test->bytes;
+   }
+   return summary;
+}
+//+------------------------------------------------------------------+
+//| Save all samples to the binary trace file                        |
+//+------------------------------------------------------------------+
+bool Test::SaveTrace() {
+   if (m_cfg.trace.empty()) return true;
+   // there are no samples to save in histogram mode
+   if (m_recording != RECORDING_SAMPLES) {
+      std::cerr << "Test \"" << m_name << "\" trace is not available with histogram recording" << std::endl;
+      return false;
+   }
+
+   // write trace
+   std::string path = ResolvePath(m_cfg.trace, m_name);
+   TraceWriter writer;
+   if (!writer.Write(path, m_cfg, m_running)) return false;
+   std::cout << "Test \"" << m_name << "\" trace saved to " << path << std::endl;
+   return true;
+}
+//+------------------------------------------------------------------+
+//| Output file path                                                 |
+//+------------------------------------------------------------------+
+std::string Test::ResolvePath(const std::string& pattern, const std::string& test_name) {
+   // substitute test name, keep it safe for the file system
+   std::string path = pattern, name = test_name;
+   for (auto& c : name)
+      if (!isalnum((unsigned char)c) && c != '-' && c != '.') c = '_';
+   for (size_t pos; (pos = path.find("{name}")) != std::string::npos;)
+      path.replace(pos, 6, name);
+   // relative paths are located next to the program
+   bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\' || path.find(':') != std::string::npos);
+   if (!absolute)
+      path = std::string(ExtProgramPath) + BENCH_PATH_SEP + path;
+   return path;
+}
+//+------------------------------------------------------------------+
+//| Convert raw clock ticks to nanoseconds                           |
+//+------------------------------------------------------------------+
+void Test::ConvertTimings(RunTestCfg* test) {
+   if (!test) return;
+   // probe overhead is subtracted once per sample (i.e. per batch)
+   for (auto& t : test->timings) {
+      t.timestamp = ExtClock.ToNs(t.timestamp);
+      t.duration  = ExtClock.DurationNs(t.duration);
+   }
+}
+//+------------------------------------------------------------------+
 //| Format duration as string                                        |
 //+------------------------------------------------------------------+
-std::string Test::FormatDuration(int64_t duration_ns) {
+std::string Test::FormatDuration(double duration_ns) {
    constexpr int precision = 3;
 
    if (duration_ns < 1'000) {                // < 1 us
-      return std::to_string(duration_ns) + " ns";
+      // fractional nanoseconds come from per-call timings of batches
+      if (duration_ns == std::floor(duration_ns))
+         return std::to_string(int64_t(duration_ns)) + " ns";
+      std::ostringstream oss;
+      oss << std::fixed << std::setprecision(precision) << duration_ns << " ns";
+      return oss.str();
    }
    else if (duration_ns < 1'000'000) {       // < 1 ms
       double us = duration_ns / 1'000.0;
@@ -246,72 +692,440 @@ std::string Test::FormatDuration(int64_t duration_ns) {
    }
 }
 //+------------------------------------------------------------------+
-//| Calculate median                                                 |
+//| Copy thread durations in nanoseconds                             |
 //+------------------------------------------------------------------+
-inline uint64_t TimingsMedian(const RunTestCfg::Timings& timings) {
-   if (timings.empty()) return 0;
-
-   std::vector<uint64_t> durations;
-   durations.reserve(timings.size());
-   for (const auto& t : timings)
-      durations.push_back(t.duration);
+void Test::ProcessTimings(RunTestCfg* test, uint64_t* durations) {
+   // convert clock ticks to nanoseconds
+   ConvertTimings(test);
+   for (const auto& t : test->timings)
+      *durations++ = t.duration;
+}
+//+------------------------------------------------------------------+
+//| Print min/max/avg/med                                            |
+//+------------------------------------------------------------------+
+void Test::PrintStats(const std::string& id, const SampleStats& stats, const RunTestCfg* test) {
+   std::cout << "  [" << std::setw(2) << std::right << id << "] min/max/avg/med = ";
+   if (stats.count > 0) {
+      // timings are stored per sample, show them per call
+      double batch = double(m_batch);
+      std::cout << std::setw(10) << std::right << FormatDuration(stats.min  / batch) << " / "
+                << std::setw(10) << std::right << FormatDuration(stats.max  / batch) << " / "
+                << std::setw(10) << std::right << FormatDuration(stats.mean / batch) << " / "
+                << std::setw(10) << std::right << FormatDuration(stats.med  / batch) << " / ";
+   }
+   else
+      std::cout << std::setw(52) << std::right << "/ ";
+   // thread initializers
+   if (test)
+      std::cout << (test->context_init.empty() ? "" : ("(" + test->context_init + ") "))
+                << (test->initializer.empty() ? "-" : test->initializer);
+   else
+      std::cout << "-";
+   std::cout << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Print percentiles                                                |
+//+------------------------------------------------------------------+
+void Test::PrintPercentiles(const std::string& id, const SampleStats& stats) {
+   double batch = double(m_batch);
 
-   size_t n = durations.size();
-   auto mid = durations.begin() + n / 2;
+   std::cout << "  [" << std::setw(2) << std::right << id << "] p50/p90/p99/p99.9/p99.99/max = ";
+   if (stats.count > 0) {
+      std::cout << std::setw(10) << std::right << FormatDuration(stats.med   / batch) << " / "
+                << std::setw(10) << std::right << FormatDuration(stats.p90   / batch) << " / "
+                << std::setw(10) << std::right << FormatDuration(stats.p99   / batch) << " / "
+                << std::setw(10) << std::right << FormatDuration(stats.p999  / batch) << " / "
+                << std::setw(10) << std::right << FormatDuration(stats.p9999 / batch) << " / "
+                << std::setw(10) << std::right << FormatDuration(stats.max   / batch);
+   }
+   std::cout << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Statistics of the samples measured while all threads were        |
+//| running, per-thread start and finish skew (timings must be       |
+//| converted to nanoseconds)                                        |
+//+------------------------------------------------------------------+
+void Test::ProcessOverlap() {
+   if (m_recording != RECORDING_SAMPLES || m_running.size() < 2) return;
 
-   std::nth_element(durations.begin(), mid, durations.end());
+   // run span of every thread
+   std::vector<uint64_t> starts, finishes;
+   for (auto test : m_running) {
+      if (test->timings.empty()) return;
+      const auto& last = test->timings[test->timings.size() - 1];
+      starts.push_back(test->timings[0].timestamp);
+      finishes.push_back(last.timestamp + last.duration);
+   }
+   uint64_t first_start  = *std::min_element(starts.begin(), starts.end());
+   uint64_t last_finish  = *std::max_element(finishes.begin(), finishes.end());
+   uint64_t window_start = *std::max_element(starts.begin(), starts.end());
+   uint64_t window_end   = *std::min_element(finishes.begin(), finishes.end());
 
-   if (n % 2 != 0) {
-      return *mid;
+   std::cout << std::endl;
+   if (window_end <= window_start) {
+      std::cout << "  Overlap window: threads never ran all together" << std::endl;
+      return;
    }
-   else {
-      // for an even-sized array, we need the second central element
-      auto mid2 = *std::max_element(durations.begin(), mid);
-      return (*mid + mid2) / 2;
+   // samples completely inside the window
+   std::vector<uint64_t> durations;
+   std::vector<size_t>   counts(m_running.size(), 0);
+   size_t                total = 0;
+   for (size_t i = 0; i < m_running.size(); i++) {
+      for (const auto& t : m_running[i]->timings)
+         if (t.timestamp >= window_start && t.timestamp + t.duration <= window_end) {
+            durations.push_back(t.duration);
+            counts[i]++;
+         }
+      total += m_running[i]->timings.size();
    }
+   std::cout << "  Overlap window " << FormatDuration(double(window_end - window_start)) << " of "
+             << FormatDuration(double(last_finish - first_start)) << ", all " << m_running.size() << " threads running, "
+             << std::fixed << std::setprecision(1) << (total ? durations.size() * 100.0 / total : 0) << "% of "
+             << (RingWrapped() ? "the last " + std::to_string(m_cfg.ring) + " samples:" : "samples:")
+             << std::defaultfloat << std::endl;
+   for (size_t i = 0; i < m_running.size(); i++)
+      std::cout << "  [" << std::setw(2) << std::right << ThreadId(m_running[i]) << "] start/finish skew = "
+                << std::setw(10) << std::right << FormatDuration(double(starts[i] - first_start)) << " / "
+                << std::setw(10) << std::right << FormatDuration(double(last_finish - finishes[i])) << ", "
+                << counts[i] << " samples in the window" << std::endl;
+
+   SampleStats overlap;
+   Statistics::Calculate(durations.data(), durations.size(), overlap);
+   PrintStats("**", overlap, NULL);
+   PrintPercentiles("**", overlap);
 }
 //+------------------------------------------------------------------+
-//| Process timings from single thread                               |
+//| Throughput and p50/p99 of fixed time windows, samples belong to  |
+//| the window of their completion. Stall is a window with low       |
+//| throughput or high p99 compared with the median window.          |
 //+------------------------------------------------------------------+
-void Test::ProcessTimings(size_t id, RunTestCfg* test, RunThreadStats& stats) {
-   // initialize stats
-   stats.min = ULLONG_MAX;
-   stats.max = 0;
-   stats.avg = 0;
-   stats.sum = 0;
-   stats.med = 0;
-   // checks
-   if (!test) return;
+void Test::ProcessWindows() {
+   struct Window {
+      double      rate = 0;                  // calls per second
+      uint64_t    p50  = 0;
+      uint64_t    p99  = 0;
+      uint64_t    count= 0;
+   };
+   typedef std::vector<Window> TWindows;
+
+   if (m_cfg.window == 0) return;
+   if (m_recording != RECORDING_SAMPLES) {
+      std::cerr << "Test \"" << m_name << "\" windows are not available with histogram recording" << std::endl;
+      return;
+   }
+   // run span
+   uint64_t first = UINT64_MAX, last = 0;
+   for (auto test : m_running)
+      for (const auto& t : test->timings) {
+         first = std::min(first, t.timestamp);
+         last  = std::max(last, t.timestamp + t.duration);
+      }
+   if (first >= last) return;
+   uint64_t width = m_cfg.window;
+   if ((last - first) / width >= WINDOWS_MAX) {
+      std::cerr << "Test \"" << m_name << "\" window " << FormatDuration(double(width)) << " is too small for the run of "
+                << FormatDuration(double(last - first)) << ", at most " << WINDOWS_MAX << " windows are reported" << std::endl;
+      return;
+   }
+   size_t   total = size_t((last - first) / width) + 1;
 
-   // calculate statistics
-   if (test->timings.size() > 0) {
-      
-      for (auto& timing : test->timings) {
-         auto& t = timing.duration;
-         stats.sum += t;
-         if (t < stats.min) stats.min = t;
-         if (t > stats.max) stats.max = t;
+   // statistics of the per-thread (the last one is aggregate) durations of every window,
+   // durations are partially sorted in place
+   auto calculate = [&](std::vector<std::vector<uint64_t>>& durations) {
+      TWindows windows(durations.size());
+      for (size_t w = 0; w < durations.size(); w++) {
+         std::vector<uint64_t>& values = durations[w];
+         Window&                window = windows[w];
+         // the last window may be shorter
+         uint64_t length = std::min(width, last - (first + w * width));
+         window.count = values.size();
+         window.rate  = length ? double(window.count) * double(m_batch) * 1'000'000'000.0 / double(length) : 0;
+         if (values.empty()) continue;
+         auto at = [&values](double percentile) {
+            size_t rank = size_t(std::ceil(percentile / 100.0 * values.size()));
+            size_t index = rank ? rank - 1 : 0;
+            std::nth_element(values.begin(), values.begin() + index, values.end());
+            return values[index];
+         };
+         window.p50 = at(50.0);
+         window.p99 = at(99.0);
+      }
+      return windows;
+   };
+   std::vector<TWindows>              threads;
+   std::vector<std::vector<uint64_t>> aggregate(total);
+   for (auto test : m_running) {
+      std::vector<std::vector<uint64_t>> durations(total);
+      for (const auto& t : test->timings) {
+         size_t w = size_t((t.timestamp + t.duration - first) / width);
+         durations[w].push_back(t.duration);
+         aggregate[w].push_back(t.duration);
       }
-      stats.avg = stats.sum / test->timings.size();
-      stats.med = TimingsMedian(test->timings);
+      threads.push_back(calculate(durations));
+   }
+   TWindows windows = calculate(aggregate);
 
-      std::cout << "  ["
-                << std::setw(2)  << std::right << id << "] min/max/avg/med = "
-                << std::setw(10) << std::right << FormatDuration(stats.min) << " / "
-                << std::setw(10) << std::right << FormatDuration(stats.max) << " / "
-                << std::setw(10) << std::right << FormatDuration(stats.avg) << " / "
-                << std::setw(10) << std::right << FormatDuration(stats.med) << " / "
-                << (test->context_init.empty() ?"":("("+ test->context_init +") "))
-                << (test->initializer.empty()?"-": test->initializer)
-                << std::endl;
+   // median window of the complete windows
+   auto median = [total](const TWindows& list, auto field) {
+      std::vector<double> values;
+      for (size_t w = 0; w + 1 < total || (total == 1 && w < total); w++)
+         values.push_back(double(list[w].*field));
+      std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+      return values[values.size() / 2];
+   };
+   auto stall = [&](const TWindows& list, size_t w, double median_rate, double median_p99) {
+      // incomplete last window has lower throughput
+      bool complete = w + 1 < total || (last - first) % width == 0;
+      if (complete && list[w].rate < median_rate * STALL_THROUGHPUT) return true;
+      return median_p99 > 0 && double(list[w].p99) > median_p99 * STALL_LATENCY;
+   };
+   double              median_rate = median(windows, &Window::rate);
+   double              median_p99  = median(windows, &Window::p99);
+   std::vector<double> thread_rate, thread_p99;
+   for (const auto& list : threads) {
+      thread_rate.push_back(median(list, &Window::rate));
+      thread_p99.push_back(median(list, &Window::p99));
    }
-   else {
-      std::cout << "  ["
-                << std::setw(2)  << std::right << id << "] min/max/avg/med = "
-                << std::setw(52) << std::right << "/ "
-                << (test->context_init.empty() ? "" : ("(" + test->context_init + ") "))
-                << (test->initializer.empty() ? "-" : test->initializer)
-                << std::endl;
+
+   // print aggregate and per-thread windows
+   size_t stalls = 0, thread_stalls = 0;
+   std::cout << std::endl << "  Windows of " << FormatDuration(double(width)) << ", calls/s and per-call p50/p99:" << std::endl;
+   auto print = [&](const std::string& id, const Window& window, bool stalled) {
+      double batch = double(m_batch);
+      std::cout << id << std::fixed << std::setprecision(0) << std::setw(13) << window.rate << std::defaultfloat
+                << std::setw(12) << (window.count ? FormatDuration(window.p50 / batch) : "-")
+                << std::setw(12) << (window.count ? FormatDuration(window.p99 / batch) : "-")
+                << (stalled ? "  STALL" : "") << std::endl;
+   };
+   for (size_t w = 0; w < total; w++) {
+      bool stalled = stall(windows, w, median_rate, median_p99);
+      if (stalled) stalls++;
+      std::ostringstream id;
+      id << "  [w" << std::setw(4) << std::right << w << "] " << std::setw(12) << std::right << FormatDuration(double(w * width));
+      print(id.str(), windows[w], stalled);
+      for (size_t i = 0; i < threads.size(); i++) {
+         bool thread_stalled = stall(threads[i], w, thread_rate[i], thread_p99[i]);
+         if (thread_stalled) thread_stalls++;
+         if (!m_cfg.window_threads) continue;
+         std::ostringstream tid;
+         tid << "      [" << std::setw(2) << std::right << ThreadId(m_running[i]) << "]" << std::setw(13) << "";
+         print(tid.str(), threads[i][w], thread_stalled);
+      }
+   }
+   std::cout << "  Stall windows: " << stalls << " of " << total << ", threads stalls: " << thread_stalls << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Print page faults of the measured window and buffer warnings     |
+//+------------------------------------------------------------------+
+void Test::PrintFaults() {
+   uint64_t    minor = 0, major = 0;
+   bool        valid = false;
+   std::string warnings;
+   for (auto test : m_running) {
+      // all threads allocate with the same flags, show warnings once
+      if (warnings.empty()) warnings = test->buffer_warnings;
+      if (!test->faults_valid) continue;
+      minor += test->faults_minor;
+      major += test->faults_major;
+      valid  = true;
+   }
+   if (warnings.size() > 2)
+      std::cerr << "Test \"" << m_name << "\" samples buffer: " << warnings.substr(0, warnings.size() - 2) << std::endl;
+   if (valid)
+      std::cout << "Test \"" << m_name << "\" page faults while measuring: " << minor << " minor, " << major << " major" << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Start skew of threads, offsets from the earliest one             |
+//+------------------------------------------------------------------+
+void Test::PrintStart() {
+   if (m_running.size() < 2) return;
+   uint64_t first = UINT64_MAX, last = 0;
+   for (auto test : m_running) {
+      first = std::min(first, test->start);
+      last  = std::max(last, test->start);
+   }
+   std::cout << "Test \"" << m_name << "\" start skew (" << (m_cfg.start == START_SPIN ? "spin" : "barrier") << "): "
+             << FormatDuration(double(last - first)) << ", per thread:";
+   for (auto test : m_running)
+      std::cout << " +" << FormatDuration(double(test->start - first));
+   std::cout << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Print CPU and NUMA node of every thread                          |
+//+------------------------------------------------------------------+
+void Test::PrintPlacement() {
+   // placement is interesting if it was chosen or could matter
+   if (m_cfg.affinity == AFFINITY_NONE && ExtTopology.Nodes() < 2) return;
+   std::cout << std::endl;
+   for (size_t i = 0; i < m_running.size(); i++) {
+      auto test = m_running[i];
+      std::cout << "  [" << std::setw(2) << std::right << ThreadId(m_running[i]) << "] cpu/node = "
+                << test->cpu_end << " / " << ExtTopology.Node(test->cpu_end);
+      if (test->cpu < 0) std::cout << ", not pinned";
+      // unpinned threads may move during the run
+      if (test->cpu_start != test->cpu_end)
+         std::cout << ", started on " << test->cpu_start << " / " << ExtTopology.Node(test->cpu_start);
+      std::cout << std::endl;
+   }
+}
+//+------------------------------------------------------------------+
+//| Print samples counts of time limited and adaptive runs           |
+//+------------------------------------------------------------------+
+void Test::PrintSamples() {
+   if (!m_cfg.samples_auto && !m_cfg.duration) return;
+   size_t converged = 0;
+   std::cout << "Test \"" << m_name << "\" samples:";
+   for (size_t i = 0; i < m_running.size(); i++) {
+      std::cout << (i ? " / " : " ") << m_running[i]->completed;
+      if (m_running[i]->converged) converged++;
+   }
+   if (m_cfg.samples_auto)
+      std::cout << ", median CI converged in " << converged << " of " << m_running.size() << " threads";
+   std::cout << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Some thread overwrote its earliest samples in the ring           |
+//+------------------------------------------------------------------+
+bool Test::RingWrapped() const {
+   if (m_recording != RECORDING_SAMPLES) return false;
+   for (auto test : m_running)
+      if (test->completed > test->timings.size()) return true;
+   return false;
+}
+//+------------------------------------------------------------------+
+//| Print target and achieved throughput of the fixed rate mode      |
+//+------------------------------------------------------------------+
+void Test::PrintRate() {
+   if (m_cfg.rate <= 0 || m_elapsed <= 0) return;
+   // calls completed by all threads per second of the run, including the ones overwritten in the ring
+   size_t completed = 0;
+   for (auto test : m_running) completed += test->completed;
+   double achieved = double(completed) * double(m_batch) * 1'000'000'000.0 / m_elapsed;
+   std::cout << "Test \"" << m_name << "\" rate: target " << std::fixed << std::setprecision(1) << m_cfg.rate
+             << " calls/s, achieved " << achieved << " calls/s (" << std::setprecision(1) << achieved * 100.0 / m_cfg.rate << "%)"
+             << std::defaultfloat << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Print processed items and bytes per second of wall time, thread  |
+//| rates use the samples loop time of the thread, the pooled rate   |
+//| uses the run time, ns/item is the thread time per item           |
+//+------------------------------------------------------------------+
+void Test::PrintWork() {
+   uint64_t items = 0, bytes = 0, thread_time = 0;
+   for (auto test : m_running) {
+      items       += test->items;
+      bytes       += test->bytes;
+      thread_time += test->elapsed;
+   }
+   if (!items && !bytes) return;
+   auto print = [](const std::string& id, uint64_t items, uint64_t bytes, double wall, double thread_time) {
+      std::cout << "  [" << std::setw(2) << std::right << id << "] ";
+      if (wall <= 0) {
+         std::cout << "-" << std::endl;
+         return;
+      }
+      double seconds = wall / 1'000'000'000.0;
+      if (items)
+         std::cout << std::setw(14) << FormatRate(double(items) / seconds, "items/s") << ", "
+                   << std::setw(12) << FormatDuration(thread_time / double(items)) << "/item";
+      if (items && bytes) std::cout << ", ";
+      if (bytes)
+         std::cout << std::setw(12) << FormatRate(double(bytes) / seconds, "B/s");
+      std::cout << std::endl;
+   };
+   std::cout << std::endl << "Test \"" << m_name << "\" work " << (m_running.empty() || !m_running[0]->work_reported ? "declared per call" : "reported by the plugin") << ":" << std::endl;
+   for (size_t i = 0; i < m_running.size(); i++)
+      print(ThreadId(m_running[i]), m_running[i]->items, m_running[i]->bytes, double(m_running[i]->elapsed), double(m_running[i]->elapsed));
+   print("**", items, bytes, m_elapsed, double(thread_time));
+}
+//+------------------------------------------------------------------+
+//| Print heap activity of the measured calls per sample             |
+//+------------------------------------------------------------------+
+void Test::PrintAllocations() {
+   if (!m_cfg.allocations) return;
+   if (!AllocTracker::Available()) {
+      std::cout << "Test \"" << m_name << "\" allocations: not available in this build" << std::endl;
+      return;
+   }
+   auto print = [](const std::string& id, const AllocCounters& allocs, size_t samples) {
+      std::cout << "  [" << std::setw(2) << std::right << id << "] ";
+      if (!samples) {
+         std::cout << "-" << std::endl;
+         return;
+      }
+      double count = double(samples);
+      std::cout << std::fixed << std::setprecision(3) << std::setw(10) << double(allocs.allocations) / count << " allocs, "
+                << std::setw(10) << double(allocs.frees) / count << " frees, "
+                << std::setprecision(1) << std::setw(12) << double(allocs.bytes) / count << " bytes per sample, peak live "
+                << allocs.peak << " bytes" << std::defaultfloat
+                << (allocs.allocations == 0 ? ", no allocations" : "") << std::endl;
+   };
+   AllocCounters pooled{};
+   size_t        samples = 0;
+   std::cout << std::endl << "Test \"" << m_name << "\" heap allocations of the measured calls:" << std::endl;
+   for (size_t i = 0; i < m_running.size(); i++) {
+      const auto& allocs = m_running[i]->allocs;
+      print(ThreadId(m_running[i]), allocs, m_running[i]->completed);
+      pooled.allocations += allocs.allocations;
+      pooled.frees       += allocs.frees;
+      pooled.bytes       += allocs.bytes;
+      pooled.peak         = std::max(pooled.peak, allocs.peak);
+      samples            += m_running[i]->completed;
+   }
+   // peak of the pooled row is the largest peak of a thread
+   print("**", pooled, samples);
+}
+//+------------------------------------------------------------------+
+//| Rate with decimal prefix                                         |
+//+------------------------------------------------------------------+
+std::string Test::FormatRate(double value, const char* unit) {
+   static const char* prefixes[] = { "", "K", "M", "G", "T" };
+   size_t prefix = 0;
+   while (value >= 1000.0 && prefix < 4) {
+      value /= 1000.0;
+      prefix++;
+   }
+   std::ostringstream oss;
+   oss << std::fixed << std::setprecision(3) << value << " " << prefixes[prefix] << unit;
+   return oss.str();
+}
+//+------------------------------------------------------------------+
+//| Print performance counters per call and IPC                      |
+//+------------------------------------------------------------------+
+void Test::PrintCounters(const std::string& id, const uint64_t* values, uint32_t opened, uint64_t calls) {
+   auto format = [opened, calls](int counter, double value) {
+      if (!(opened & PerfCounters::Mask(EnCounter(counter))) || calls == 0) return std::string("-");
+      std::ostringstream oss;
+      oss << std::fixed << std::setprecision(3) << value;
+      return oss.str();
+   };
+
+   std::cout << "  [" << std::setw(2) << std::right << id << "] cycles/instructions/IPC/llc-misses/branch-misses/ctx-switches = ";
+   double per_call = calls ? 1.0 / double(calls) : 0;
+   double ipc      = values[COUNTER_CYCLES] ? double(values[COUNTER_INSTRUCTIONS]) / double(values[COUNTER_CYCLES]) : 0;
+   std::cout << std::setw(10) << std::right << format(COUNTER_CYCLES,           values[COUNTER_CYCLES]           * per_call) << " / "
+             << std::setw(10) << std::right << format(COUNTER_INSTRUCTIONS,     values[COUNTER_INSTRUCTIONS]     * per_call) << " / "
+             << std::setw(6)  << std::right << ((opened & PerfCounters::Mask(COUNTER_CYCLES)) && (opened & PerfCounters::Mask(COUNTER_INSTRUCTIONS)) ? format(COUNTER_CYCLES, ipc) : "-") << " / "
+             << std::setw(8)  << std::right << format(COUNTER_LLC_MISSES,       values[COUNTER_LLC_MISSES]       * per_call) << " / "
+             << std::setw(8)  << std::right << format(COUNTER_BRANCH_MISSES,    values[COUNTER_BRANCH_MISSES]    * per_call) << " / "
+             << format(COUNTER_CONTEXT_SWITCHES, values[COUNTER_CONTEXT_SWITCHES] * per_call) << std::endl;
+}
+//+------------------------------------------------------------------+
+//| Print stddev, MAD, CV, median confidence interval, outliers      |
+//+------------------------------------------------------------------+
+void Test::PrintDispersion(const std::string& id, const SampleStats& stats) {
+   double batch = double(m_batch);
+
+   std::cout << "  [" << std::setw(2) << std::right << id << "] stddev/MAD/CV/med 95% CI/outliers = ";
+   if (stats.count > 0) {
+      std::ostringstream cv;
+      cv << std::fixed << std::setprecision(3) << stats.cv;
+      std::cout << std::setw(10) << std::right << FormatDuration(stats.stddev / batch) << " / "
+                << std::setw(10) << std::right << FormatDuration(stats.mad    / batch) << " / "
+                << std::setw(6)  << std::right << cv.str() << " / "
+                << std::setw(24) << std::right << (FormatDuration(stats.med_low / batch) + " .. " + FormatDuration(stats.med_high / batch)) << " / "
+                << stats.outliers_mild << " mild, " << stats.outliers_extreme << " extreme";
    }
+   std::cout << std::endl;
 }
 //+------------------------------------------------------------------+
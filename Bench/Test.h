@@ -5,12 +5,51 @@
 //+------------------------------------------------------------------+
 #pragma once
 #include "TestFactory.h"
+#include "Clock.h"
+#include "Histogram.h"
+#include "Statistics.h"
+#include "Counters.h"
+#include "Topology.h"
+#include "PageBuffer.h"
+#include "Allocations.h"
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <barrier>
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
 
+//+------------------------------------------------------------------+
+//| How samples are recorded                                         |
+//+------------------------------------------------------------------+
+enum EnRecording {
+   RECORDING_SAMPLES,                        // every sample is stored
+   RECORDING_HISTOGRAM,                      // samples are counted in a fixed size histogram
+};
+//+------------------------------------------------------------------+
+//| Samples arrival in the open-loop (fixed rate) mode               |
+//+------------------------------------------------------------------+
+enum EnArrival {
+   ARRIVAL_CONSTANT,                         // equal intervals
+   ARRIVAL_POISSON,                          // exponentially distributed intervals
+};
+//+------------------------------------------------------------------+
+//| Test execution environment                                       |
+//+------------------------------------------------------------------+
+enum EnIsolation {
+   ISOLATION_NONE,                           // all tests run in the Bench process
+   ISOLATION_PROCESS,                        // every test runs in its own child process
+};
+//+------------------------------------------------------------------+
+//| How threads start the measured part                              |
+//+------------------------------------------------------------------+
+enum EnStart {
+   START_BARRIER,                            // threads leave the barrier as the OS wakes them up
+   START_SPIN,                               // threads spin until the common deadline
+};
 //+------------------------------------------------------------------+
 //| Configuration of a single test                                   |
 //+------------------------------------------------------------------+
@@ -18,45 +57,168 @@ struct TestCfg {
    struct ThreadInit {
       std::string initializer;
       std::string context;
+      int         cpu = -1;                  // explicit CPU, -1 to use the affinity policy
    };
 
    typedef std::vector<ThreadInit>                      Threads;
    typedef std::unordered_map<std::string, std::string> Contexts;
+   typedef std::unordered_map<std::string, int>         ContextNodes;
+   typedef std::vector<std::pair<std::string, std::string>> Params;
 
 
    std::string    name;                      // test name
    std::string    library;                   // name of the DLL
    size_t         concurrency;               // number of concurrent threads
+   std::vector<size_t> sweep;                // concurrency levels to run one by one, empty for single run
    size_t         samples;                   // number of test iterations per thread
+   bool           samples_auto;              // sample until the median confidence interval is narrow enough
+   double         ci_width;                  // relative width of the median 95% CI for samples_auto
+   uint64_t       duration;                  // run time limit in nanoseconds, 0 for samples count only
+   uint64_t       warmup;                    // discarded warmup time in nanoseconds
+   size_t         warmup_samples;            // discarded warmup samples
+   size_t         batch;                     // number of test function calls per sample
+   EnRecording    recording;                 // samples recording mode
+   int            precision;                 // histogram significant digits
+   std::string    trace;                     // binary trace file path, "{name}" is replaced with the test name
+   size_t         ring;                      // keep only the last samples in a ring of this size, 0 to keep all
+   bool           progress;                  // print status every second
+   uint64_t       window;                    // telemetry window in nanoseconds, 0 to disable
+   bool           window_threads;            // print telemetry of every thread
+   unsigned       pages;                     // samples buffer pages, EnPageFlags
+   uint32_t       counters;                  // performance counters mask, PerfCounters::Mask
+   EnCounterScope counters_scope;            // counted region
+   double         rate;                      // target calls per second of all threads, 0 for the closed loop
+   double         items;                     // work items per call, 0 to take them from the plugin
+   double         bytes;                     // bytes processed per call, 0 to take them from the plugin
+   bool           allocations;               // count heap allocations of the measured calls
+   EnIsolation    isolation;                 // run the test in a separate process
+   size_t         processes;                 // worker processes of the test, 1 to run it in this process
+   std::string    launch;                    // worker command template, "{command}" is the worker command line
+   std::string    coordinator;               // address the workers connect to, "host[:port]"
+   EnArrival      arrival;                   // intervals between samples for the fixed rate
+   EnStart        start;                     // start of the measured part
+   uint64_t       start_spin;                // spin before the start deadline in nanoseconds
+   EnAffinity     affinity;                  // threads placement
+   std::vector<int> affinity_cpus;           // CPUs of AFFINITY_LIST
+   size_t         affinity_offset;           // first layout position, group members take consecutive slices
    ThreadInit     thread_default;            // default threads initializer
    Threads        threads;                   // per-thread initializers
    Contexts       contexts;                  // contexts map [name=>initializer]
+   ContextNodes   context_nodes;             // NUMA nodes of contexts [initializer=>node]
+   std::vector<TestCfg> group;               // tests running simultaneously, empty for a single test
+   bool           solo;                      // run every group member alone before the group
+   std::vector<TestCfg> points;              // parameter matrix points, empty for a single test
+   Params         params;                    // parameter values of the point, "{key}" in initializers
+};
+//+------------------------------------------------------------------+
+//| Live progress of a test thread, written by the thread only and   |
+//| read by the monitor, occupies own cache lines                    |
+//+------------------------------------------------------------------+
+struct alignas(64) TestProgress {
+   static constexpr int BUCKETS = 64;
+
+   std::atomic<uint64_t> samples{0};         // completed samples
+   std::atomic<uint64_t> min{UINT64_MAX};    // clock ticks
+   std::atomic<uint64_t> max{0};
+   std::atomic<uint64_t> buckets[BUCKETS];   // samples by log2 of duration in ticks
+
+   TestProgress() { for (auto& b : buckets) b.store(0, std::memory_order_relaxed); }
+};
+//+------------------------------------------------------------------+
+//| Start deadline published once and polled by spinning threads,    |
+//| occupies own cache line                                          |
+//+------------------------------------------------------------------+
+struct alignas(64) StartGate {
+   std::atomic<uint64_t> deadline{0};        // steady clock nanoseconds, 0 until published
 };
 //+------------------------------------------------------------------+
 //| Configuration of a single running test thread                    |
 //+------------------------------------------------------------------+
 struct RunTestCfg {
    struct TimingEntry {
-      uint64_t    timestamp;  // QPC timestamp
-      uint64_t    duration;   // measured time of test sample
+      uint64_t    timestamp;  // clock ticks while running, nanoseconds after ConvertTimings
+      uint64_t    duration;   // measured time of test sample, same units as timestamp
    };
-   typedef std::vector<TimingEntry> Timings;
+   typedef PageBuffer<TimingEntry> Timings;
 
+   size_t         index;                     // position in the configuration, thread number in reports
    std::string    initializer;
    std::string    context_init;
    ITest*         instance;
-   size_t         samples;
-   Timings        timings;
+   size_t         samples;                   // samples limit, SIZE_MAX for time limited runs
+   double         ci_width;                  // stop when the median CI is narrower, 0 to disable
+   uint64_t       duration;                  // nanoseconds, 0 for unlimited
+   uint64_t       warmup;                    // nanoseconds
+   size_t         warmup_samples;
+   bool           converged;                 // stopped by the median CI width
+   Histogram      ci_histogram;              // recorded samples checked for convergence, nanoseconds
+   size_t         ci_recorded;               // samples already added to ci_histogram
+   size_t         batch;
+   EnRecording    recording;
+   Timings        timings;                   // RECORDING_SAMPLES
+   size_t         ring;                      // ring size, 0 for all samples
+   unsigned       pages;                     // timings pages flags
+   Histogram      histogram;                 // RECORDING_HISTOGRAM, nanoseconds
+   int            precision;                 // histogram significant digits
+   std::string    buffer_warnings;           // page flags which were not applied
+   bool           buffer_failed;             // recording buffer allocation failed
+   uint64_t       faults_minor;              // page faults of the measured window
+   uint64_t       faults_major;
+   bool           faults_valid;              // page faults are counted on this platform
+   bool           progress_enabled;          // publish progress
+   TestProgress   progress;
+   uint32_t       counters_mask;             // requested performance counters
+   EnCounterScope counters_scope;
+   PerfCounters   counters;                  // opened by the test thread itself
+   std::string    counters_error;            // counters which failed to open
+   double         interval;                  // mean clock ticks between intended starts, 0 for the closed loop
+   double         phase;                     // intended start of the first sample, ticks after the start
+   EnArrival      arrival;
+   uint64_t       seed;                      // Poisson arrivals generator seed
+   int            cpu;                       // pinned CPU, -1 if not pinned
+   int            cpu_start;                 // CPU observed before the start
+   int            cpu_end;                   // CPU observed after the end
+   uint64_t       start;                     // steady clock nanoseconds when the thread started measuring
+   bool           work_reported;             // the plugin reports processed items and bytes
+   size_t         completed;                 // measured samples including the ones overwritten in the ring
+   uint64_t       elapsed;                   // wall time of the samples loop in nanoseconds
+   uint64_t       items;                     // work items of the measured samples
+   uint64_t       bytes;                     // bytes of the measured samples
+   bool           alloc_tracking;            // count heap allocations inside the timed region
+   AllocCounters  allocs;                    // heap activity of the measured calls
 };
 //+------------------------------------------------------------------+
-//| Per-thread statistics                                            |
+//| Resource usage of the process which ran the test                 |
 //+------------------------------------------------------------------+
-struct RunThreadStats {
-   uint64_t       min;
-   uint64_t       max;
-   uint64_t       avg;
-   uint64_t       med;
-   uint64_t       sum;
+struct ProcessUsage {
+   bool           valid;                     // the test ran in a separate process
+   uint64_t       max_rss;                   // peak resident set in bytes
+   uint64_t       faults_minor;
+   uint64_t       faults_major;
+   uint64_t       switches_voluntary;        // context switches waiting for a resource
+   uint64_t       switches_involuntary;      // preemptions
+   double         user;                      // CPU time in nanoseconds
+   double         system;
+};
+//+------------------------------------------------------------------+
+//| Results of a test run                                            |
+//+------------------------------------------------------------------+
+struct TestSummary {
+   size_t         threads;                   // number of running threads
+   size_t         batch;                     // calls per sample
+   uint64_t       calls;                     // completed calls of all threads
+   double         elapsed;                   // wall time in nanoseconds
+   double         throughput;                // calls per second
+   SampleStats    stats;                     // pooled statistics, per sample
+   std::vector<SampleStats> thread_stats;    // per-thread statistics, per sample
+   Histogram      histogram;                 // pooled durations, per sample
+   TestCfg        cfg;
+   std::string    revision;                  // plugin source revision
+   uint64_t       items;                     // work items of all threads, 0 if not accounted
+   uint64_t       bytes;                     // bytes of all threads, 0 if not accounted
+   ProcessUsage   usage;                     // resources of the isolated test process
+   uint64_t       counters[COUNTER_TOTAL];   // performance counters of all threads
+   uint32_t       counters_opened;           // mask of counters opened by any thread
 };
 //+------------------------------------------------------------------+
 //|                                                                  |
@@ -65,26 +227,99 @@ class Test {
    typedef std::vector<RunTestCfg*>                TTests;
    typedef std::vector<std::thread>                TThreads;
    typedef std::unordered_map<std::string, UINT64> TContexts;
+   typedef std::vector<SampleStats>                TStats;
+
+   static constexpr size_t TIMINGS_CHUNK     = 65536;   // initial timings storage of time limited runs
+   static constexpr size_t CONVERGENCE_CHECK = 1024;    // first median convergence check, then it doubles
+   static constexpr double STALL_THROUGHPUT  = 0.5;     // stall window throughput, part of the median window
+   static constexpr double STALL_LATENCY     = 10.0;    // stall window p99, times of the median window p99
+   static constexpr size_t WINDOWS_MAX       = 10'000;  // windows of the run span, smaller window is rejected
 
 private:
    TestFactory       m_factory;
    TTests            m_tests;
+   TTests            m_running;              // threads which created test instances, valid after Join
    TThreads          m_threads;
    TContexts         m_contexts;
    std::string       m_name;
+   TestCfg           m_cfg;
+   size_t            m_batch;
+   EnRecording       m_recording;
+   TStats            m_stats;                // per-thread statistics
+   SampleStats       m_pooled;               // statistics of all threads samples
+   Histogram         m_histogram;            // durations of all threads samples
+   double            m_elapsed;              // wall time of the run in nanoseconds
+   std::mutex        m_create_lock;          // worker threads create test instances one by one
+   std::mutex        m_monitor_lock;         // progress monitor wakeup
+   std::condition_variable m_monitor_wake;
+   bool              m_finished;             // all threads completed
+   bool              m_warmup_sync;          // threads wait for the end of warmup of all threads
+   std::atomic<size_t> m_arrived;            // barrier arrivals of all threads, for external start gates
+   std::atomic<size_t> m_created;            // threads ready to run, final after the first barrier
+   std::chrono::high_resolution_clock::time_point m_start_time;
+   StartGate         m_start_gate;           // common start of spinning threads
+   std::atomic<uint64_t> m_schedule_anchor;  // clock ticks of the first scheduled loop start, 0 until set
+   std::thread       m_monitor;
+
+   template<class T> friend class TestRunner;
 
 public:
                      Test();
                     ~Test();
 
    bool              Initialize(const TestCfg& cfg);
-   void              Run();
+   bool              Run();
+   // run in steps with a start barrier shared with other tests, every thread arrives once,
+   // and once more after warmup if warmup_sync is set
+   void              Launch(std::barrier<>& sync, bool warmup_sync);
+   // spinning threads start at the deadline (steady clock nanoseconds), 0 to count it from now
+   void              Started(uint64_t deadline = 0);
+   bool              Join();
+   size_t            Threads() const         { return m_tests.size(); }
+   size_t            Arrived() const         { return m_arrived.load(); }
+   bool              HasWarmup() const       { return m_cfg.warmup || m_cfg.warmup_samples; }
    void              ProcessStatistics();
+   bool              SaveTrace();
+   TestSummary       Summary() const;
+
+   static std::string FormatDuration(double duration_ns);
+   static void       PrintCounters(const std::string& id, const uint64_t* values, uint32_t opened, uint64_t calls);
+   // relative paths are located next to the program, "{name}" is replaced with the name
+   static std::string ResolvePath(const std::string& pattern, const std::string& test_name);
 
 private:
    UINT64            CreateContext(const std::string& context_init);
    void              RunTest(std::barrier<>& sync, RunTestCfg* test);
-   std::string       FormatDuration(int64_t duration_ns);
-   void              ProcessTimings(size_t id, RunTestCfg* test, RunThreadStats& stats);
+   void              Warmup(RunTestCfg* test);
+   void              Monitor();
+   bool              Converged(RunTestCfg* test, size_t count);
+   bool              PrepareRecording(RunTestCfg* test);
+   static bool       PageFaults(uint64_t& minor, uint64_t& major);
+   // samples loop templates are in TestLoop.h, built-in tests instantiate them for their classes
+   template<class TInstance>
+   size_t            RunLoop(RunTestCfg* test, TInstance* instance);
+   template<class TClock, class TInstance>
+   size_t            RunWithClock(RunTestCfg* test, TInstance* instance);
+   template<class TClock, class TInstance, bool batched, bool scheduled>
+   size_t            RunSamples(RunTestCfg* test, TInstance* instance);
+   void              ConvertTimings(RunTestCfg* test);
+   void              ProcessTimings(RunTestCfg* test, uint64_t* durations);
+   static std::string ThreadId(const RunTestCfg* test) { return std::to_string(test->index + 1); }
+   void              PrintStats(const std::string& id, const SampleStats& stats, const RunTestCfg* test);
+   void              PrintPercentiles(const std::string& id, const SampleStats& stats);
+   void              PrintDispersion(const std::string& id, const SampleStats& stats);
+   void              PrintRate();
+   void              PrintWork();
+   void              PrintAllocations();
+   static std::string FormatRate(double value, const char* unit);
+   void              PrintSamples();
+   bool              RingWrapped() const;
+   void              PrintPlacement();
+   void              PrintStart();
+   void              ProcessOverlap();
+   void              ProcessWindows();
+   void              PrintFaults();
 };
+// globals
+extern std::atomic<bool> ExtStop;            // stop requested (SIGINT), tests finish at the next sample
 //+------------------------------------------------------------------+
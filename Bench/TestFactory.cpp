@@ -5,20 +5,41 @@
 //+------------------------------------------------------------------+
 #include "TestFactory.h"
 #include <iostream>
+#include <cstdio>
+#include <cstring>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 // global variable
 char ExtProgramPath[MAX_PATH] = "";
 //+------------------------------------------------------------------+
+//| Dynamic libraries helpers                                        |
+//+------------------------------------------------------------------+
+#ifdef _WIN32
+static bool        LibExists(LPCSTR filename)                { return GetFileAttributes(filename) != INVALID_FILE_ATTRIBUTES; }
+static HMODULE     LibOpen(LPCSTR filename)                  { return LoadLibrary(filename); }
+static void        LibClose(HMODULE lib)                     { FreeLibrary(lib); }
+static void*       LibSymbol(HMODULE lib, LPCSTR name)       { return reinterpret_cast<void*>(GetProcAddress(lib, name)); }
+static std::string LibError()                                { return "error " + std::to_string(GetLastError()); }
+#else
+static bool        LibExists(LPCSTR filename)                { return access(filename, F_OK) == 0; }
+static HMODULE     LibOpen(LPCSTR filename)                  { return dlopen(filename, RTLD_NOW | RTLD_LOCAL); }
+static void        LibClose(HMODULE lib)                     { dlclose(lib); }
+static void*       LibSymbol(HMODULE lib, LPCSTR name)       { return dlsym(lib, name); }
+static std::string LibError()                                { const char* err = dlerror(); return err ? err : "unknown error"; }
+#endif
+//+------------------------------------------------------------------+
 //| Initialization                                                   |
 //+------------------------------------------------------------------+
-TestFactory::TestFactory() :m_lib(NULL), m_fnBtCreateTest(NULL),
+TestFactory::TestFactory() :m_lib(NULL), m_version(0), m_builtin(false), m_fnBtCreateTest(NULL),
                             m_fnBtCreateContext(NULL), m_fnDestroyContext(NULL) {
 }
 //+------------------------------------------------------------------+
 //| Free resources                                                   |
 //+------------------------------------------------------------------+
 TestFactory::~TestFactory() {
-   if (m_lib) FreeLibrary(m_lib);
+   if (m_lib) LibClose(m_lib);
 }
 //+------------------------------------------------------------------+
 //| Load library and check it                                        |
@@ -27,42 +48,73 @@ bool TestFactory::Load(LPCSTR path, LPCSTR initializer) {
    char filename[MAX_PATH];
    // checks
    if (!path || !initializer) return false;
+   // test compiled into Bench
+   if (strncmp(path, BUILTIN_PREFIX, strlen(BUILTIN_PREFIX)) == 0) {
+      const BuiltinTest* builtin = BuiltinTests::Find(path + strlen(BUILTIN_PREFIX));
+      if (!builtin) {
+         std::cerr << "Error: built-in test " << path + strlen(BUILTIN_PREFIX) << " not found" << std::endl;
+         return false;
+      }
+      m_fnBtCreateTest    = builtin->create;
+      m_fnBtCreateContext = builtin->create_context;
+      m_fnDestroyContext  = builtin->destroy_context;
+      m_version           = BENCH_API_VERSION;
+      m_builtin           = true;
+      m_initializer       = initializer;
+      return true;
+   }
    // prepare path
-   _snprintf_s(filename, _countof(filename), _TRUNCATE, "%s\\tests\\%s", ExtProgramPath, path);
-
-   // check if file exists
-   if (GetFileAttributes(filename) == INVALID_FILE_ATTRIBUTES) {
-      std::cerr << "Error: DLL not found at path: " << filename << std::endl;
+   int res = snprintf(filename, sizeof(filename), "%s" BENCH_PATH_SEP "tests" BENCH_PATH_SEP "%s", ExtProgramPath, path);
+   if (res < 0 || size_t(res) >= sizeof(filename)) {
+      std::cerr << "Error: DLL path is too long: " << path << std::endl;
       return false;
    }
 
+   // check if file exists, the same config could be used on both platforms
+   // so "name.dll" is also looked up as "name.so" and vice versa
+   if (!LibExists(filename)) {
+      size_t len = strlen(filename), ext = strlen(BENCH_LIB_EXT_ALT);
+      if (len > ext && strcmp(filename + len - ext, BENCH_LIB_EXT_ALT) == 0)
+         snprintf(filename + len - ext, sizeof(filename) - (len - ext), "%s", BENCH_LIB_EXT);
+      if (!LibExists(filename)) {
+         std::cerr << "Error: DLL not found at path: " << filename << std::endl;
+         return false;
+      }
+   }
+
    // load DLL
-   if ((m_lib = LoadLibrary(filename)) != NULL) {
+   if ((m_lib = LibOpen(filename)) != NULL) {
       // load functions
-      BtVersion_t BtVersion= reinterpret_cast<BtVersion_t>(GetProcAddress(m_lib, "BtVersion"));
-      m_fnBtCreateTest     = reinterpret_cast<BtCreateTest_t>(GetProcAddress(m_lib, "BtCreateTest"));
-      m_fnBtCreateContext  = reinterpret_cast<BtCreateContext_t>(GetProcAddress(m_lib, "BtCreateContext"));
-      m_fnDestroyContext   = reinterpret_cast<BtDestroyContext_t>(GetProcAddress(m_lib, "BtDestroyContext"));
+      BtVersion_t BtVersion= reinterpret_cast<BtVersion_t>(LibSymbol(m_lib, "BtVersion"));
+      m_fnBtCreateTest     = reinterpret_cast<BtCreateTest_t>(LibSymbol(m_lib, "BtCreateTest"));
+      m_fnBtCreateContext  = reinterpret_cast<BtCreateContext_t>(LibSymbol(m_lib, "BtCreateContext"));
+      m_fnDestroyContext   = reinterpret_cast<BtDestroyContext_t>(LibSymbol(m_lib, "BtDestroyContext"));
+      BtRevision_t BtRevision = reinterpret_cast<BtRevision_t>(LibSymbol(m_lib, "BtRevision"));
 
       // check functions pointers
       if (BtVersion && m_fnBtCreateTest) {
-         // check version
+         // check version, older plugins are still supported
          int version = BtVersion();
-         if (version == BENCH_API_VERSION) {
+         if (version >= BENCH_API_VERSION_MIN && version <= BENCH_API_VERSION) {
+            // store version, it defines available ITest entry points
+            m_version = version;
             // store initializer
             if (initializer)
                m_initializer = initializer;
+            // source revision is optional
+            const char* revision = BtRevision ? BtRevision() : NULL;
+            m_revision = revision ? revision : "";
             // everything is ok
             return true;
          }
          else
-            std::cerr << "Error: DLL " << path << " version is " << version << ", but " << BENCH_API_VERSION << " is required" << std::endl;
+            std::cerr << "Error: DLL " << path << " version is " << version << ", but " << BENCH_API_VERSION_MIN << ".." << BENCH_API_VERSION << " is required" << std::endl;
       }
       else
          std::cerr << "Error: DLL " << path << " is missing required functions" << std::endl;
    }
    else
-      std::cerr << "Error: Failed to load DLL " << path << " (error " << GetLastError() << ")" << std::endl;
+      std::cerr << "Error: Failed to load DLL " << path << " (" << LibError() << ")" << std::endl;
 
    // something went wrong
    return false;
@@ -91,7 +143,7 @@ ITest* TestFactory::CreateTest(LPCSTR initializer, UINT64 context) {
 //+------------------------------------------------------------------+
 UINT64 TestFactory::CreateContext(LPCSTR initializer) {
    if (m_fnBtCreateContext) return m_fnBtCreateContext(initializer);
-   return NULL;
+   return 0;
 }
 //+------------------------------------------------------------------+
 //| Destroy context                                                  |
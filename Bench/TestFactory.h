@@ -4,10 +4,12 @@
 //|                                    https://github.com/arthur-cpp |
 //+------------------------------------------------------------------+
 #pragma once
-#include <windows.h>
+#include "Platform.h"
 #include <string>
+#include <map>
 
-#define BENCH_API_VERSION 4
+#define BENCH_API_VERSION     6
+#define BENCH_API_VERSION_MIN 4        // oldest plugins API still accepted
 //+------------------------------------------------------------------+
 //| Interface to the test                                            |
 //+------------------------------------------------------------------+
@@ -18,6 +20,10 @@ public:
    virtual int       RunBefore() = 0;  // before test
    virtual int       Run()       = 0;  // measured test function
    virtual int       RunAfter()  = 0;  // after test
+   // API version 5, never called for older plugins
+   virtual int       RunBatch(size_t count) = 0; // run measured test function count times
+   // API version 6, never called for older plugins
+   virtual void      Processed(UINT64* items, UINT64* bytes) = 0; // work done by the instance since its creation
 };
 //+------------------------------------------------------------------+
 //| DLL functions definitions                                        |
@@ -26,22 +32,67 @@ typedef int    (*BtVersion_t)();
 typedef ITest* (*BtCreateTest_t) (const char* initializer, UINT64 context);
 typedef UINT64 (*BtCreateContext_t)(const char* initializer);
 typedef void   (*BtDestroyContext_t)(UINT64);
+typedef const char* (*BtRevision_t)();  // optional, source revision of the plugin
+//+------------------------------------------------------------------+
+//| Test compiled into Bench, its samples loop is instantiated for   |
+//| its class, see TestRunner.h                                      |
+//+------------------------------------------------------------------+
+class Test;
+struct RunTestCfg;
+
+class IBuiltinTest : public ITest {
+public:
+   virtual size_t    RunLoop(Test& owner, RunTestCfg* test) = 0; // samples loop, returns completed samples
+};
+//+------------------------------------------------------------------+
+//| Tests compiled into Bench, registered by BENCH_REGISTER          |
+//+------------------------------------------------------------------+
+struct BuiltinTest {
+   BtCreateTest_t       create;
+   BtCreateContext_t    create_context;
+   BtDestroyContext_t   destroy_context;
+};
+
+class BuiltinTests {
+   typedef std::map<std::string, BuiltinTest> TTests;
+
+public:
+   static bool          Add(const char* name, const BuiltinTest& test) { Registry()[name] = test; return true; }
+   static const BuiltinTest* Find(const std::string& name) {
+      auto it = Registry().find(name);
+      return it != Registry().end() ? &it->second : NULL;
+   }
+
+private:
+   // filled by static initializers of any translation unit
+   static TTests&       Registry()            { static TTests tests; return tests; }
+};
 //+------------------------------------------------------------------+
 //|                                                                  |
 //+------------------------------------------------------------------+
 class TestFactory {
 private:
    HMODULE              m_lib;
+   int                  m_version;
+   bool                 m_builtin;            // test is compiled into Bench
    std::string          m_initializer;
+   std::string          m_revision;
    BtCreateTest_t       m_fnBtCreateTest;
    BtCreateContext_t    m_fnBtCreateContext;
    BtDestroyContext_t   m_fnDestroyContext;
 
 public:
+   static constexpr const char* BUILTIN_PREFIX = "builtin:";   // "load" prefix of the built-in tests
+
                         TestFactory();
                        ~TestFactory();
 
    bool                 Load(LPCSTR path, LPCSTR initializer);
+   int                  Version() const       { return m_version;      }
+   bool                 SupportsBatch() const { return m_version >= 5; }
+   bool                 SupportsWork() const  { return m_version >= 6; }
+   bool                 Builtin() const       { return m_builtin;      }
+   const std::string&   Revision() const      { return m_revision;     }
 
    ITest*               CreateTest(LPCSTR initializer, UINT64 context);
    UINT64               CreateContext(LPCSTR initializer);
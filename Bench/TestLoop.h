@@ -0,0 +1,197 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include "Test.h"
+#include <iostream>
+#include <cmath>
+#include <random>
+#include <bit>
+
+//+------------------------------------------------------------------+
+//| Calls of the test class in the samples loop. Plugins go through  |
+//| the ITest vtable, built-in tests are called directly and their   |
+//| missing hooks are compiled out                                   |
+//+------------------------------------------------------------------+
+template<class T>
+struct TestHooks {
+   static constexpr bool before = requires(T& t) { t.RunBefore(); };
+   static constexpr bool after  = requires(T& t) { t.RunAfter(); };
+   static constexpr bool batch  = requires(T& t, size_t count) { t.RunBatch(count); };
+   static constexpr bool work   = requires(T& t, UINT64* value) { t.Processed(value, value); };
+
+   static int        Before(T& t) {
+      if constexpr (before) return t.RunBefore();
+      else                  return true;
+   }
+   static int        After(T& t) {
+      if constexpr (after)  return t.RunAfter();
+      else                  return true;
+   }
+   // without RunBatch the batch is a loop inlined into the timed region
+   static int        Batch(T& t, size_t count) {
+      if constexpr (batch)  return t.RunBatch(count);
+      else {
+         for (size_t i = 0; i < count; i++)
+            if (!t.Run()) return false;
+         return true;
+      }
+   }
+   static void       Processed(T& t, UINT64* items, UINT64* bytes) {
+      if constexpr (work)   t.Processed(items, bytes);
+      else                  *items = *bytes = 0;
+   }
+};
+//+------------------------------------------------------------------+
+//| Select samples loop for the clock, the clock is a template       |
+//| parameter to keep the samples loop free of dispatching           |
+//+------------------------------------------------------------------+
+template<class TInstance>
+size_t Test::RunLoop(RunTestCfg* test, TInstance* instance) {
+   switch (ExtClock.Type()) {
+      case CLOCK_TYPE_STEADY:        return RunWithClock<ClockSteady>(test, instance);
+#ifdef _WIN32
+      case CLOCK_TYPE_QPC:           return RunWithClock<ClockQpc>(test, instance);
+#else
+      case CLOCK_TYPE_MONOTONIC_RAW: return RunWithClock<ClockMonotonicRaw>(test, instance);
+#endif
+#ifdef BENCH_X86
+      case CLOCK_TYPE_TSC:           return RunWithClock<ClockTsc>(test, instance);
+      case CLOCK_TYPE_TSCP:          return RunWithClock<ClockTscp>(test, instance);
+#endif
+      default:                       return 0;
+   }
+}
+//+------------------------------------------------------------------+
+//| Select samples loop for batches and fixed rate                   |
+//+------------------------------------------------------------------+
+template<class TClock, class TInstance>
+size_t Test::RunWithClock(RunTestCfg* test, TInstance* instance) {
+   // batched sample times the whole batch with a single timestamps pair
+   if (test->interval > 0) {
+      if (test->batch > 1) return RunSamples<TClock, TInstance, true, true>(test, instance);
+      return RunSamples<TClock, TInstance, false, true>(test, instance);
+   }
+   if (test->batch > 1) return RunSamples<TClock, TInstance, true, false>(test, instance);
+   return RunSamples<TClock, TInstance, false, false>(test, instance);
+}
+//+------------------------------------------------------------------+
+//| Samples loop, returns number of completed samples.               |
+//| Scheduled loop is open: every sample waits for its intended      |
+//| start and its latency is measured from it, so a slow sample      |
+//| delays the next ones and the delay is counted (coordinated       |
+//| omission correction).                                            |
+//+------------------------------------------------------------------+
+template<class TClock, class TInstance, bool batched, bool scheduled>
+size_t Test::RunSamples(RunTestCfg* test, TInstance* instance) {
+   typedef TestHooks<TInstance> Hooks;
+   auto timings  = test->timings.data();
+   auto batch    = test->batch;
+   bool samples  = test->recording == RECORDING_SAMPLES;
+   bool counters = test->counters_mask && test->counters_scope == COUNTERS_SCOPE_SAMPLE;
+   bool allocs   = test->alloc_tracking;
+   // schedule of intended starts, next interval is drawn while waiting
+   std::mt19937_64                      rng(test->seed);
+   std::exponential_distribution<double> exponential(1.0);
+   bool   poisson  = test->arrival == ARRIVAL_POISSON;
+   double intended = 0;
+   if constexpr (scheduled) {
+      uint64_t now = TClock::Start();
+      if (poisson) intended = double(now) + test->interval * exponential(rng);
+      else {
+         // constant arrivals of all threads are interleaved on one grid anchored at the first thread start,
+         // threads leaving the barrier later join it at their next slot
+         uint64_t anchor = 0;
+         if (m_schedule_anchor.compare_exchange_strong(anchor, now)) anchor = now;
+         intended = double(anchor) + test->phase;
+         if (intended < double(now)) intended += std::ceil((double(now) - intended) / test->interval) * test->interval;
+      }
+   }
+   // time limit and median convergence checks at doubling samples counts
+   uint64_t deadline = UINT64_MAX;
+   if (test->duration)
+      deadline = TClock::Start() + uint64_t(ExtClock.Frequency() * double(test->duration) / 1'000'000'000.0);
+   size_t check = CONVERGENCE_CHECK;
+   bool   ring  = test->ring > 0;
+   size_t slot  = 0;
+   // live progress, single writer doesn't need atomic increments
+   bool          progress = test->progress_enabled;
+   TestProgress& status   = test->progress;
+   uint64_t      min      = UINT64_MAX, max = 0;
+   // loop through
+   size_t count;
+   for (count = 0; count < test->samples; count++) {
+      // wrap the ring, or grow storage of time limited runs
+      if (samples && slot == test->timings.size()) {
+         if (ring) slot = 0;
+         else {
+            // out of memory, the run ends with the samples recorded so far
+            if (!test->timings.resize(test->timings.size() * 2)) {
+               std::lock_guard<std::mutex> lock(m_create_lock);
+               std::cerr << "Test \"" << m_name << "\" failed to grow samples buffer, stopped after " << count << " samples" << std::endl;
+               break;
+            }
+            timings = test->timings.data();
+         }
+      }
+      // prepare before test
+      if (!Hooks::Before(*instance)) break;
+
+      // wait for the intended start, samples behind the schedule start at once
+      uint64_t due = 0;
+      if constexpr (scheduled) {
+         due = uint64_t(intended);
+         while (TClock::Start() < due)
+            if (ExtStop.load(std::memory_order_relaxed)) return count;
+         intended += poisson ? test->interval * exponential(rng) : test->interval;
+      }
+      // counters are switched outside of the timed region
+      if (counters) test->counters.Enable();
+      if (allocs)   AllocTracker::Enable();
+      // run one sample of the test
+      int      res;
+      uint64_t start = TClock::Start();
+      if constexpr (batched) res = Hooks::Batch(*instance, batch);
+      else                   res = instance->Run();
+      uint64_t end = TClock::Stop();
+      if (allocs)   AllocTracker::Disable();
+      if (counters) test->counters.Disable();
+      // failed sample stops the test, tracking is already switched off
+      if (!res) break;
+      // latency includes the time the sample waited behind the previous ones
+      if constexpr (scheduled) start = due;
+
+      // store raw timing data (timestamp and duration of the whole sample)
+      if (samples) {
+         auto t = timings + slot++;
+         t->timestamp = start;
+         t->duration  = end - start;
+      }
+      else
+         test->histogram.Record(ExtClock.DurationNs(end - start));
+
+      // after test
+      if (!Hooks::After(*instance)) break;
+
+      // publish progress
+      if (progress) {
+         uint64_t duration = end - start;
+         auto&    bucket   = status.buckets[63 - std::countl_zero(duration | 1)];
+         bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+         if (duration < min) status.min.store(min = duration, std::memory_order_relaxed);
+         if (duration > max) status.max.store(max = duration, std::memory_order_relaxed);
+         status.samples.store(count + 1, std::memory_order_relaxed);
+      }
+      // stop by Ctrl+C, by time or by the median confidence interval
+      if (ExtStop.load(std::memory_order_relaxed)) return count + 1;
+      if (end >= deadline) return count + 1;
+      if (test->ci_width > 0 && count + 1 == check) {
+         if (Converged(test, count + 1)) return count + 1;
+         check *= 2;
+      }
+   }
+   return count;
+}
+//+------------------------------------------------------------------+
@@ -0,0 +1,61 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include "TestLoop.h"
+#include <type_traits>
+
+//+------------------------------------------------------------------+
+//| Test class compiled into Bench. The samples loop is instantiated |
+//| for T, so its calls are not virtual and can be inlined, and      |
+//| missing RunBefore/RunAfter/RunBatch are compiled out.            |
+//| T needs "int Run()" only, optional members are:                  |
+//|   T(const char* initializer, UINT64 context)                     |
+//|   int RunBefore(), int RunAfter(), int RunBatch(size_t count)    |
+//|   void Processed(UINT64* items, UINT64* bytes)                   |
+//|   static UINT64 CreateContext(const char* initializer)           |
+//|   static void DestroyContext(UINT64 context)                     |
+//+------------------------------------------------------------------+
+template<class T>
+class TestRunner final : public IBuiltinTest {
+   typedef TestHooks<T> Hooks;
+
+private:
+   T                 m_test;
+
+public:
+   template<class... Args>
+   explicit          TestRunner(Args&&... args) : m_test(std::forward<Args>(args)...) {}
+
+   // warmup and work accounting, out of the samples loop
+   virtual void      Release() override               { delete this; }
+   virtual int       RunBefore() override             { return Hooks::Before(m_test); }
+   virtual int       Run() override                   { return m_test.Run(); }
+   virtual int       RunAfter() override              { return Hooks::After(m_test); }
+   virtual int       RunBatch(size_t count) override  { return Hooks::Batch(m_test, count); }
+   virtual void      Processed(UINT64* items, UINT64* bytes) override { Hooks::Processed(m_test, items, bytes); }
+   // samples loop of the class
+   virtual size_t    RunLoop(Test& owner, RunTestCfg* test) override { return owner.RunLoop(test, &m_test); }
+
+   // registry entry points
+   static ITest*     Create(const char* initializer, UINT64 context) {
+      if constexpr (std::is_constructible_v<T, const char*, UINT64>) return new TestRunner(initializer, context);
+      else                                                          return new TestRunner();
+   }
+   static UINT64     CreateContext(const char* initializer) {
+      if constexpr (requires(const char* init) { T::CreateContext(init); }) return T::CreateContext(initializer);
+      else                                                                 return 0;
+   }
+   static void       DestroyContext(UINT64 context) {
+      if constexpr (requires(UINT64 ctx) { T::DestroyContext(ctx); }) T::DestroyContext(context);
+   }
+   static BuiltinTest Entry()                         { return BuiltinTest{ &Create, &CreateContext, &DestroyContext }; }
+};
+//+------------------------------------------------------------------+
+//| Register test class T as "load: builtin:T"                       |
+//+------------------------------------------------------------------+
+#define BENCH_REGISTER(T) \
+   [[maybe_unused]] static const bool BenchRegistered##T = BuiltinTests::Add(#T, TestRunner<T>::Entry())
+//+------------------------------------------------------------------+
@@ -0,0 +1,240 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "Topology.h"
+#include "Platform.h"
+#include <iostream>
+#include <algorithm>
+#include <tuple>
+#include <map>
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#include <dirent.h>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#endif
+
+// global variable
+Topology ExtTopology;
+//+------------------------------------------------------------------+
+//| Initialization                                                   |
+//+------------------------------------------------------------------+
+Topology::Topology() : m_nodes(1) {
+}
+#ifdef _WIN32
+//+------------------------------------------------------------------+
+//| Read topology of the process CPUs (single processor group)       |
+//+------------------------------------------------------------------+
+bool Topology::Load() {
+   DWORD_PTR process_mask = 0, system_mask = 0;
+   DWORD     length = 0;
+
+   m_cpus.clear();
+   m_nodes = 1;
+   if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) return false;
+   GetLogicalProcessorInformation(NULL, &length);
+   std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+   if (info.empty() || !GetLogicalProcessorInformation(info.data(), &length)) return false;
+
+   // locations by CPU mask bits
+   std::map<int, CpuInfo> cpus;
+   for (int cpu = 0; cpu < int(sizeof(DWORD_PTR) * 8); cpu++)
+      if (process_mask & (DWORD_PTR(1) << cpu)) cpus[cpu] = CpuInfo{ cpu, 0, 0, 0, 0 };
+   int core = 0, package = 0;
+   for (const auto& item : info) {
+      int smt = 0;
+      for (auto& it : cpus) {
+         if (!(item.ProcessorMask & (DWORD_PTR(1) << it.first))) continue;
+         switch (item.Relationship) {
+            case RelationProcessorCore:    it.second.core = core; it.second.smt = smt++; break;
+            case RelationProcessorPackage: it.second.package = package;                 break;
+            case RelationNumaNode:         it.second.node = int(item.NumaNode.NodeNumber);
+                                           m_nodes = std::max(m_nodes, it.second.node + 1); break;
+            default:                       break;
+         }
+      }
+      if (item.Relationship == RelationProcessorCore)    core++;
+      if (item.Relationship == RelationProcessorPackage) package++;
+   }
+   for (const auto& it : cpus) m_cpus.push_back(it.second);
+   return !m_cpus.empty();
+}
+//+------------------------------------------------------------------+
+//| Pin the calling thread                                           |
+//+------------------------------------------------------------------+
+bool Topology::Pin(int cpu) {
+   if (cpu < 0 || cpu >= int(sizeof(DWORD_PTR) * 8)) return false;
+   return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+}
+//+------------------------------------------------------------------+
+//| CPU of the calling thread                                        |
+//+------------------------------------------------------------------+
+int Topology::CurrentCpu() {
+   return int(GetCurrentProcessorNumber());
+}
+#else
+//+------------------------------------------------------------------+
+//| Read integer from the sysfs file                                 |
+//+------------------------------------------------------------------+
+static int ReadSysInt(const char* path, int def) {
+   FILE* file = fopen(path, "r");
+   int   value;
+   if (!file) return def;
+   if (fscanf(file, "%d", &value) != 1) value = def;
+   fclose(file);
+   return value;
+}
+//+------------------------------------------------------------------+
+//| Read topology of the process CPUs from sysfs                     |
+//+------------------------------------------------------------------+
+bool Topology::Load() {
+   cpu_set_t set;
+   char      path[MAX_PATH];
+
+   m_cpus.clear();
+   m_nodes = 1;
+   CPU_ZERO(&set);
+   if (sched_getaffinity(0, sizeof(set), &set) != 0) return false;
+   for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (!CPU_ISSET(cpu, &set)) continue;
+      CpuInfo info{ cpu, 0, 0, 0, 0 };
+      snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+      info.core = ReadSysInt(path, cpu);
+      snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+      info.package = ReadSysInt(path, 0);
+      // NUMA node is the "nodeN" link in the CPU directory
+      snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+      if (DIR* dir = opendir(path)) {
+         while (dirent* entry = readdir(dir))
+            if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9')
+               info.node = atoi(entry->d_name + 4);
+         closedir(dir);
+      }
+      m_nodes = std::max(m_nodes, info.node + 1);
+      m_cpus.push_back(info);
+   }
+   // SMT index in the order of logical numbers
+   std::map<std::pair<int, int>, int> siblings;
+   for (auto& info : m_cpus)
+      info.smt = siblings[{ info.package, info.core }]++;
+   return !m_cpus.empty();
+}
+//+------------------------------------------------------------------+
+//| Pin the calling thread                                           |
+//+------------------------------------------------------------------+
+bool Topology::Pin(int cpu) {
+   cpu_set_t set;
+   if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+   CPU_ZERO(&set);
+   CPU_SET(cpu, &set);
+   return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+//+------------------------------------------------------------------+
+//| CPU of the calling thread                                        |
+//+------------------------------------------------------------------+
+int Topology::CurrentCpu() {
+   return sched_getcpu();
+}
+#endif
+//+------------------------------------------------------------------+
+//| Print summary                                                    |
+//+------------------------------------------------------------------+
+void Topology::Print() const {
+   int cores = 0, packages = 0;
+   for (const auto& info : m_cpus) {
+      if (info.smt == 0)       cores++;
+      packages = std::max(packages, info.package + 1);
+   }
+   std::cout << "Topology: " << m_cpus.size() << " CPUs, " << cores << " cores, "
+             << packages << " packages, " << m_nodes << " NUMA nodes" << std::endl;
+}
+//+------------------------------------------------------------------+
+//| NUMA node of the CPU                                             |
+//+------------------------------------------------------------------+
+int Topology::Node(int cpu) const {
+   for (const auto& info : m_cpus)
+      if (info.cpu == cpu) return info.node;
+   return -1;
+}
+//+------------------------------------------------------------------+
+//| First available CPU of the node                                  |
+//+------------------------------------------------------------------+
+int Topology::NodeCpu(int node) const {
+   for (const auto& info : m_cpus)
+      if (info.node == node) return info.cpu;
+   return -1;
+}
+//+------------------------------------------------------------------+
+//| CPUs for the threads, wraps around if there are more threads     |
+//+------------------------------------------------------------------+
+std::vector<int> Topology::Layout(EnAffinity affinity, size_t count, const std::vector<int>& list) const {
+   std::vector<int> cpus(count, -1);
+   TCpus            order;
+
+   switch (affinity) {
+      case AFFINITY_LIST:
+         for (size_t i = 0; i < count && !list.empty(); i++)
+            cpus[i] = list[i % list.size()];
+         return cpus;
+      case AFFINITY_COMPACT:
+         order = m_cpus;
+         std::sort(order.begin(), order.end(), [](const CpuInfo& a, const CpuInfo& b) {
+            return std::tie(a.node, a.package, a.core, a.smt, a.cpu) < std::tie(b.node, b.package, b.core, b.smt, b.cpu);
+         });
+         break;
+      case AFFINITY_SCATTER:
+      case AFFINITY_PHYSICAL: {
+         // rank of the core within its package, so packages alternate
+         std::map<std::pair<int, int>, int> ranks;
+         std::map<int, int>                 cores;
+         for (const auto& info : m_cpus)
+            if (ranks.find({ info.package, info.core }) == ranks.end())
+               ranks[{ info.package, info.core }] = cores[info.package]++;
+         for (const auto& info : m_cpus)
+            if (affinity == AFFINITY_SCATTER || info.smt == 0)
+               order.push_back(info);
+         std::sort(order.begin(), order.end(), [&ranks](const CpuInfo& a, const CpuInfo& b) {
+            int ra = ranks[{ a.package, a.core }], rb = ranks[{ b.package, b.core }];
+            return std::tie(a.smt, ra, a.package, a.cpu) < std::tie(b.smt, rb, b.package, b.cpu);
+         });
+         break;
+      }
+      default:
+         return cpus;
+   }
+   if (order.empty()) return cpus;
+   if (count > order.size())
+      std::cerr << "Topology: " << count << " threads share " << order.size() << " CPUs of \"" << Name(affinity) << "\" layout" << std::endl;
+   for (size_t i = 0; i < count; i++)
+      cpus[i] = order[i % order.size()].cpu;
+   return cpus;
+}
+//+------------------------------------------------------------------+
+//| Parse policy name                                                |
+//+------------------------------------------------------------------+
+bool Topology::Parse(const std::string& name, EnAffinity& affinity) {
+   if (name == "none")     { affinity = AFFINITY_NONE;     return true; }
+   if (name == "compact")  { affinity = AFFINITY_COMPACT;  return true; }
+   if (name == "scatter")  { affinity = AFFINITY_SCATTER;  return true; }
+   if (name == "physical") { affinity = AFFINITY_PHYSICAL; return true; }
+   return false;
+}
+//+------------------------------------------------------------------+
+//| Policy name                                                      |
+//+------------------------------------------------------------------+
+const char* Topology::Name(EnAffinity affinity) {
+   switch (affinity) {
+      case AFFINITY_NONE:     return "none";
+      case AFFINITY_COMPACT:  return "compact";
+      case AFFINITY_SCATTER:  return "scatter";
+      case AFFINITY_PHYSICAL: return "physical";
+      case AFFINITY_LIST:     return "list";
+      default:                break;
+   }
+   return "unknown";
+}
+//+------------------------------------------------------------------+
@@ -0,0 +1,61 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include <vector>
+#include <string>
+
+//+------------------------------------------------------------------+
+//| Threads placement policy                                         |
+//+------------------------------------------------------------------+
+enum EnAffinity {
+   AFFINITY_NONE,                            // threads are not pinned
+   AFFINITY_COMPACT,                         // fill cores and their SMT siblings node by node
+   AFFINITY_SCATTER,                         // spread over packages and cores, SMT siblings last
+   AFFINITY_PHYSICAL,                        // one thread per physical core
+   AFFINITY_LIST,                            // explicit CPU list
+};
+//+------------------------------------------------------------------+
+//| Logical CPU location                                             |
+//+------------------------------------------------------------------+
+struct CpuInfo {
+   int            cpu;                       // logical CPU number
+   int            core;                      // physical core id within the package
+   int            package;                   // socket
+   int            node;                      // NUMA node
+   int            smt;                       // index among SMT siblings of the core
+};
+//+------------------------------------------------------------------+
+//| CPU topology of the CPUs available to the process                |
+//+------------------------------------------------------------------+
+class Topology {
+   typedef std::vector<CpuInfo> TCpus;
+
+private:
+   TCpus             m_cpus;                 // sorted by logical CPU number
+   int               m_nodes;                // number of NUMA nodes
+
+public:
+                     Topology();
+
+   bool              Load();
+   void              Print() const;
+
+   int               Nodes() const           { return m_nodes; }
+   // NUMA node of the CPU, -1 if unknown
+   int               Node(int cpu) const;
+   // first available CPU of the node, -1 if there are none
+   int               NodeCpu(int node) const;
+   // CPUs for the threads, -1 for not pinned threads
+   std::vector<int>  Layout(EnAffinity affinity, size_t count, const std::vector<int>& list) const;
+
+   static bool       Pin(int cpu);
+   static int        CurrentCpu();
+   static bool       Parse(const std::string& name, EnAffinity& affinity);
+   static const char*Name(EnAffinity affinity);
+};
+// globals
+extern Topology ExtTopology;
+//+------------------------------------------------------------------+
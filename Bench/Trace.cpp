@@ -0,0 +1,94 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#include "Trace.h"
+#include <iostream>
+#include <yaml-cpp/yaml.h>
+
+//+------------------------------------------------------------------+
+//| Write trace of the test threads, timings are in nanoseconds      |
+//+------------------------------------------------------------------+
+bool TraceWriter::Write(const std::string& path, const TestCfg& cfg, const std::vector<RunTestCfg*>& tests) {
+   m_file.open(path, std::ios::binary | std::ios::trunc);
+   if (!m_file) {
+      std::cerr << "Trace: failed to create file " << path << std::endl;
+      return false;
+   }
+
+   // header
+   m_file.write(MAGIC, sizeof(MAGIC));
+   WriteValue(VERSION);
+   WriteValue(uint32_t(tests.size()));
+   WriteValue(ExtClock.Frequency());
+   WriteValue(uint64_t(ExtClock.Overhead()));
+   WriteValue(uint32_t(ExtClock.Subtract() ? FLAG_SUBTRACTED : 0));
+   WriteValue(uint32_t(tests.empty() ? cfg.batch : tests[0]->batch));
+   WriteString(Clock::Name(ExtClock.Type()));
+   WriteString(ConfigText(cfg));
+
+   // threads table
+   for (size_t i = 0; i < tests.size(); i++) {
+      WriteValue(uint32_t(tests[i]->index + 1));
+      WriteValue(uint64_t(tests[i]->timings.size()));
+      WriteString(tests[i]->initializer);
+      WriteString(tests[i]->context_init);
+   }
+
+   // columns are streamed through a small buffer, so the trace doesn't double memory
+   m_buffer.resize(BUFFER_SIZE);
+   for (auto test : tests) {
+      WriteColumn(test->timings, &RunTestCfg::TimingEntry::timestamp);
+      WriteColumn(test->timings, &RunTestCfg::TimingEntry::duration);
+   }
+   m_buffer.clear();
+   m_buffer.shrink_to_fit();
+
+   // check result
+   m_file.close();
+   if (m_file.fail()) {
+      std::cerr << "Trace: failed to write file " << path << std::endl;
+      return false;
+   }
+   return true;
+}
+//+------------------------------------------------------------------+
+//| Write length-prefixed string                                     |
+//+------------------------------------------------------------------+
+void TraceWriter::WriteString(const std::string& str) {
+   WriteValue(uint32_t(str.size()));
+   m_file.write(str.data(), str.size());
+}
+//+------------------------------------------------------------------+
+//| Write single field of all timing entries                         |
+//+------------------------------------------------------------------+
+template<class TField>
+void TraceWriter::WriteColumn(const RunTestCfg::Timings& timings, TField field) {
+   size_t total = timings.size();
+   for (size_t pos = 0; pos < total; pos += BUFFER_SIZE) {
+      size_t count = std::min(BUFFER_SIZE, total - pos);
+      for (size_t i = 0; i < count; i++)
+         m_buffer[i] = timings[pos + i].*field;
+      m_file.write(reinterpret_cast<const char*>(m_buffer.data()), count * sizeof(uint64_t));
+   }
+}
+//+------------------------------------------------------------------+
+//| Test configuration as YAML, strings are escaped by the emitter   |
+//+------------------------------------------------------------------+
+std::string TraceWriter::ConfigText(const TestCfg& cfg) {
+   YAML::Emitter out;
+   out << YAML::BeginMap
+       << YAML::Key << "name"         << YAML::Value << YAML::DoubleQuoted << cfg.name
+       << YAML::Key << "load"         << YAML::Value << YAML::DoubleQuoted << cfg.library
+       << YAML::Key << "init"         << YAML::Value << YAML::DoubleQuoted << cfg.thread_default.initializer
+       << YAML::Key << "context_init" << YAML::Value << YAML::DoubleQuoted << cfg.thread_default.context
+       << YAML::Key << "concurrency"  << YAML::Value << cfg.concurrency
+       << YAML::Key << "samples"      << YAML::Value << (cfg.samples_auto ? "auto" : std::to_string(cfg.samples))
+       << YAML::Key << "duration"     << YAML::Value << std::to_string(cfg.duration) + "ns"
+       << YAML::Key << "batch"        << YAML::Value << cfg.batch
+       << YAML::Key << "clock"        << YAML::Value << Clock::Name(ExtClock.Type())
+       << YAML::EndMap;
+   return std::string(out.c_str()) + "\n";
+}
+//+------------------------------------------------------------------+
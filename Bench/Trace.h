@@ -0,0 +1,44 @@
+//+------------------------------------------------------------------+
+//|              Bench  a benchmark tool that runs tests as plugins |
+//|                               Copyright (c) 2025, Arthur Valitov |
+//|                                    https://github.com/arthur-cpp |
+//+------------------------------------------------------------------+
+#pragma once
+#include "Test.h"
+#include <fstream>
+
+//+------------------------------------------------------------------+
+//| Binary trace of all samples, little-endian:                      |
+//|   header:  "BENCHTRC", uint32 version, uint32 threads,           |
+//|            double clock frequency, uint64 probe overhead ns,     |
+//|            uint32 flags, uint32 batch, string clock,             |
+//|            string config (YAML)                                  |
+//|   threads: uint32 id, uint64 samples, string init, string context|
+//|   columns: per thread uint64 timestamps[samples] (ns),           |
+//|            then uint64 durations[samples] (ns)                   |
+//| Strings are uint32 length followed by chars without terminator   |
+//+------------------------------------------------------------------+
+class TraceWriter {
+public:
+   static constexpr char     MAGIC[8]       = { 'B','E','N','C','H','T','R','C' };
+   static constexpr uint32_t VERSION        = 1;
+   static constexpr uint32_t FLAG_SUBTRACTED= 1;     // probe overhead is subtracted from durations
+
+private:
+   static constexpr size_t   BUFFER_SIZE    = 65536; // values written at once
+
+   std::ofstream     m_file;
+   std::vector<uint64_t> m_buffer;
+
+public:
+   bool              Write(const std::string& path, const TestCfg& cfg, const std::vector<RunTestCfg*>& tests);
+
+private:
+   void              WriteString(const std::string& str);
+   template<class T>
+   void              WriteValue(const T& value) { m_file.write(reinterpret_cast<const char*>(&value), sizeof(value)); }
+   template<class TField>
+   void              WriteColumn(const RunTestCfg::Timings& timings, TField field);
+   static std::string ConfigText(const TestCfg& cfg);
+};
+//+------------------------------------------------------------------+
@@ -5,8 +5,18 @@
 //+------------------------------------------------------------------+
 #pragma once
 
+#ifdef _WIN32
 // exclude rarely-used stuff from Windows headers
 #define WIN32_LEAN_AND_MEAN
 // windows Header Files
 #include <windows.h>
+#else
+// names of the Windows types used by the plugins API
+#include <cstdint>
+#include <cstddef>
+typedef int      BOOL;
+typedef uint64_t UINT64;
+#define TRUE     1
+#define FALSE    0
+#endif
 //+------------------------------------------------------------------+
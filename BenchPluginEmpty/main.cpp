@@ -5,8 +5,16 @@
 //+------------------------------------------------------------------+
 #include "pch.h"
 
+#ifdef _WIN32
 #define BENCH_API __declspec(dllexport)
+#else
+#define BENCH_API extern "C" __attribute__((visibility("default")))
+#endif
 #define BENCH_API_VERSION 4
+// source revision of the plugin, defined by the build
+#ifndef BENCH_REVISION
+#define BENCH_REVISION "unknown"
+#endif
 //+------------------------------------------------------------------+
 //| Interface to the test                                            |
 //+------------------------------------------------------------------+
@@ -35,12 +43,14 @@ class Test : public ITest {
    virtual int RunBefore() { return TRUE; }
    virtual int RunAfter()  { return TRUE; }
 };
+#ifdef _WIN32
 //+------------------------------------------------------------------+
 //| DLL entry point                                                  |
 //+------------------------------------------------------------------+
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD  ul_reason_for_call, LPVOID lpReserved) {
    return TRUE;
 }
+#endif
 //+------------------------------------------------------------------+
 //| Bench API version                                                |
 //+------------------------------------------------------------------+
@@ -70,3 +80,7 @@ BENCH_API void BtDestroyContext(UINT64) {
    // this sample plugin does nothing with the context
 }
 //+------------------------------------------------------------------+
+//| Source revision, stored with the results (optional)              |
+//+------------------------------------------------------------------+
+BENCH_API const char* BtRevision() { return BENCH_REVISION; }
+//+------------------------------------------------------------------+
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Reader of Bench binary traces (see Bench/Trace.h for the format).
+
+As a module:
+    import bench_trace
+    tr = bench_trace.load("Test.btr")
+    tr.threads[0].timestamps, tr.threads[0].durations   # numpy uint64 arrays, nanoseconds
+
+As a tool:
+    python bench_trace.py Test.btr          # per-thread summary
+    python bench_trace.py Test.btr --csv    # thread,timestamp,duration rows to stdout
+"""
+import struct
+import sys
+from dataclasses import dataclass, field
+
+import numpy as np
+
+MAGIC = b"BENCHTRC"
+FLAG_SUBTRACTED = 1
+
+
+@dataclass
+class Thread:
+    id: int
+    initializer: str
+    context: str
+    timestamps: np.ndarray = None
+    durations: np.ndarray = None
+
+
+@dataclass
+class Trace:
+    version: int
+    clock: str
+    clock_frequency: float
+    clock_overhead_ns: int
+    overhead_subtracted: bool
+    batch: int
+    config: str
+    threads: list = field(default_factory=list)
+
+
+def _read(f, fmt):
+    size = struct.calcsize(fmt)
+    data = f.read(size)
+    if len(data) != size:
+        raise ValueError("unexpected end of trace")
+    return struct.unpack(fmt, data)
+
+
+def _string(f):
+    (size,) = _read(f, "<I")
+    return f.read(size).decode("utf-8", "replace")
+
+
+def load(path):
+    """Load trace, columns are memory-mapped, so large traces aren't read into RAM at once."""
+    with open(path, "rb") as f:
+        if f.read(8) != MAGIC:
+            raise ValueError(f"{path}: not a Bench trace")
+        version, threads, freq, overhead, flags, batch = _read(f, "<IIdQII")
+        clock = _string(f)
+        config = _string(f)
+        trace = Trace(version, clock, freq, overhead, bool(flags & FLAG_SUBTRACTED), batch, config)
+
+        counts = []
+        for _ in range(threads):
+            tid, count = _read(f, "<IQ")
+            init = _string(f)
+            ctx = _string(f)
+            trace.threads.append(Thread(tid, init, ctx))
+            counts.append(count)
+        pos = f.tell()
+
+    for thread, count in zip(trace.threads, counts):
+        thread.timestamps = np.memmap(path, dtype="<u8", mode="r", offset=pos, shape=(count,)) if count else np.zeros(0, "<u8")
+        pos += count * 8
+        thread.durations = np.memmap(path, dtype="<u8", mode="r", offset=pos, shape=(count,)) if count else np.zeros(0, "<u8")
+        pos += count * 8
+    return trace
+
+
+def _fmt(ns):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if ns >= scale:
+            return f"{ns / scale:.3f} {unit}"
+    return f"{ns:.0f} ns"
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__)
+        return 1
+    trace = load(argv[1])
+    if "--csv" in argv:
+        print("thread,timestamp,duration")
+        for t in trace.threads:
+            for ts, d in zip(t.timestamps, t.durations):
+                print(f"{t.id},{ts},{d}")
+        return 0
+
+    print(f"clock {trace.clock}, {trace.clock_frequency / 1e9:.3f} GHz, probe overhead {trace.clock_overhead_ns} ns"
+          f"{' (subtracted)' if trace.overhead_subtracted else ''}, batch {trace.batch}")
+    print(trace.config)
+    start = min((int(t.timestamps[0]) for t in trace.threads if len(t.timestamps)), default=0)
+    for t in trace.threads:
+        if not len(t.durations):
+            print(f"[{t.id:2}] no samples")
+            continue
+        d = np.asarray(t.durations) / trace.batch
+        p50, p99, p999 = np.percentile(d, [50, 99, 99.9])
+        span = int(t.timestamps[-1]) + int(t.durations[-1]) - int(t.timestamps[0])
+        print(f"[{t.id:2}] {len(d)} samples, start +{_fmt(int(t.timestamps[0]) - start)}, span {_fmt(span)}, "
+              f"min {_fmt(d.min())}, p50 {_fmt(p50)}, p99 {_fmt(p99)}, p99.9 {_fmt(p999)}, max {_fmt(d.max())}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))